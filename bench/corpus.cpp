@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <random>
+#include "corpus.hpp"
+
+namespace Ru::bench
+{
+	namespace
+	{
+		constexpr corpus_style styles[]
+		{
+			corpus_style::mixed,
+			corpus_style::deep_indent,
+			corpus_style::operators,
+			corpus_style::literals,
+			corpus_style::long_strings,
+			corpus_style::unicode,
+		};
+
+		constexpr std::string_view style_names[]
+		{
+			"mixed",
+			"deep_indent",
+			"operators",
+			"literals",
+			"long_strings",
+			"unicode",
+		};
+
+		/// No keyword is made of them
+		constexpr std::string_view ascii_syllables[] {"ka", "lo", "mi", "ne", "ru", "sa", "to", "vi", "er", "os", "da", "fe"};
+		constexpr std::string_view unicode_syllables[] {"ра", "до", "ми", "жё", "λα", "μι", "θε", "名", "字", "数", "값", "이"};
+
+		constexpr std::string_view binary_operators[]
+		{
+			"+", "-", "*", "/", "%", "**", "<>", "..", "<", ">", "<=", ">=", "==",
+			"<<", ">>", "&&", "^^", "||", "<=>", "->", "+++", "|>", "<|",
+		};
+
+		/// A string ends at its first run of as many quotes as opened it, a quote is not escaped there
+		constexpr std::string_view string_escapes[] {"\\n", "\\t", "\\\\", "\\x41", "\\u451"};
+		constexpr std::string_view character_escapes[] {"\\n", "\\t", "\\\\", "\\\"", "\\x41", "\\u451"};
+
+		constexpr std::string_view words[]
+		{
+			"the", "lexer", "reads", "a", "line", "of", "text", "and", "splits", "it", "into", "tokens",
+		};
+
+		/// Appends the lines of the styles. The choices come from \c std::mt19937_64,
+		/// whose output the standard fixes, and are made with no distributions, whose output it doesn't
+		class writer
+		{
+		public:
+			writer(std::string& out, uint64_t seed)
+				: out(out)
+				, rng(seed)
+			{}
+
+			/// Appends a few lines in @p style, each block closed
+			void unit(corpus_style style)
+			{
+				switch (style)
+				{
+					case corpus_style::mixed: return unit(styles[1u + pick(std::size(styles) - 1u)]);
+					case corpus_style::deep_indent: return nested_blocks(8u + pick(40u));
+					case corpus_style::operators: return expression_lines(4u);
+					case corpus_style::literals: return literal_lines(4u);
+					case corpus_style::long_strings: return long_string(256u + pick(4096u));
+					case corpus_style::unicode: return unicode_lines(4u);
+				}
+			}
+
+		private:
+			std::string& out;
+			std::mt19937_64 rng;
+			/// Whether the names are made of \c unicode_syllables
+			bool unicode = false;
+
+			size_t pick(size_t count) noexcept { return size_t(rng() % count); }
+
+			template <class T, size_t N>
+			T const& pick(T const (&items)[N]) noexcept { return items[pick(N)]; }
+
+			void indent(size_t depth) { out.append(depth * 4u, ' '); }
+
+			void name()
+			{
+				for (auto count = 1u + pick(3u); count != 0u; --count)
+					out += unicode ? pick(unicode_syllables) : pick(ascii_syllables);
+				if (pick(4u) == 0u) out += std::to_string(pick(10u));
+			}
+
+			void number()
+			{
+				switch (pick(7u))
+				{
+					case 0: out += std::to_string(pick(1000u)); break;
+					case 1: out += std::to_string(1u + pick(999u)) + "_" + std::to_string(100u + pick(900u)); break;
+					case 2: out += "0x" + std::to_string(10u + pick(90u)) + "FF"; break;
+					case 3: out += "0b1" + std::string(1u + pick(8u), '0') + "1"; break;
+					case 4: out += std::to_string(pick(100u)) + "." + std::to_string(pick(1000u)); break;
+					case 5: out += std::to_string(1u + pick(9u)) + ".0e-" + std::to_string(pick(20u)); break;
+					case 6: out += "0x.3dp+" + std::to_string(pick(10u)); break;
+				}
+			}
+
+			void character()
+			{
+				out += '\'';
+				if (pick(3u) == 0u) out += pick(character_escapes);
+				else out += char('a' + pick(26u));
+				out += '\'';
+			}
+
+			void short_string()
+			{
+				out += '"';
+				for (auto count = 1u + pick(6u); count != 0u; --count)
+				{
+					out += pick(words);
+					out += pick(4u) == 0u ? pick(string_escapes) : " ";
+				}
+				out += '"';
+			}
+
+			void operand()
+			{
+				switch (pick(8u))
+				{
+					case 0: number(); break;
+					case 1: name(); out += '('; name(); out += ", "; number(); out += ')'; break;
+					case 2: out += '('; name(); out += ' '; out += pick(binary_operators); out += ' '; name(); out += ')'; break;
+					case 3: name(); out += '.'; name(); break;
+					default: name();
+				}
+			}
+
+			void expression(size_t operands)
+			{
+				operand();
+				for (; operands > 1u; --operands)
+				{
+					// the operators are written with and without spaces, which decides if they are unary
+					auto const spaced = pick(4u) != 0u;
+					if (spaced) out += ' ';
+					out += pick(binary_operators);
+					if (spaced) out += ' ';
+					operand();
+				}
+			}
+
+			void assignment(size_t depth, size_t operands)
+			{
+				indent(depth);
+				name();
+				out += " := ";
+				expression(operands);
+				out += '\n';
+			}
+
+			void nested_blocks(size_t depth)
+			{
+				out += "fn ";
+				name();
+				out += "(a, b) =>\n";
+				for (auto level = 1uz; level <= depth; ++level)
+				{
+					if (pick(3u) == 0u) assignment(level, 1u + pick(4u));
+					indent(level);
+					switch (pick(4u))
+					{
+						case 0: out += "while a < b =>\n"; break;
+						case 1: out += "for it in a .. b =>\n"; break;
+						case 2: out += "match a is\n"; break;
+						case 3: out += "fn inner(c) =>\n"; break;
+					}
+				}
+				// closed a few levels at a time, as the code goes back out
+				for (auto level = depth + 1u; level > 1u;)
+				{
+					assignment(level, 1u + pick(3u));
+					level -= std::min(level - 1u, 1uz + pick(4u));
+				}
+				out += "## end of a nested block\n";
+			}
+
+			void expression_lines(size_t count)
+			{
+				for (; count != 0u; --count)
+					assignment(0u, 8u + pick(24u));
+			}
+
+			void literal_lines(size_t count)
+			{
+				for (; count != 0u; --count)
+				{
+					name();
+					out += " := [";
+					for (auto items = 4u + pick(12u); items != 0u; --items)
+					{
+						switch (pick(3u))
+						{
+							case 0: number(); break;
+							case 1: character(); break;
+							case 2: short_string(); break;
+						}
+						if (items != 1u) out += ", ";
+					}
+					out += "]\n";
+				}
+			}
+
+			void long_string(size_t size)
+			{
+				name();
+				out += " := \"\"\"";
+				auto const end = out.size() + size;
+				while (out.size() < end)
+				{
+					out += pick(words);
+					out += pick(10u) == 0u ? "\n" : " ";
+				}
+				out += "\"\"\"\n";
+			}
+
+			void unicode_lines(size_t count)
+			{
+				unicode = true;
+				expression_lines(count);
+				unicode = false;
+			}
+		};
+	}
+
+	std::span<corpus_style const> corpus_styles() noexcept
+	{
+		return styles;
+	}
+
+	std::string_view name(corpus_style style) noexcept
+	{
+		return style_names[size_t(style)];
+	}
+
+	std::optional<corpus_style> find_corpus_style(std::string_view name) noexcept
+	{
+		auto const found = std::ranges::find(style_names, name);
+		if (found == std::end(style_names)) return std::nullopt;
+		return styles[found - std::begin(style_names)];
+	}
+
+	std::string make_corpus(corpus_style style, size_t size, uint64_t seed)
+	{
+		auto result = std::string();
+		result.reserve(size + 8192u);
+		auto lines = writer(result, seed);
+		while (result.size() < size)
+			lines.unit(style);
+		return result;
+	}
+}
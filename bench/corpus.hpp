@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Ru::bench
+{
+	/// What a generated text is heavy in
+	enum class corpus_style : uint_fast8_t
+	{
+		mixed,        ///< a bit of every other style
+		deep_indent,  ///< blocks nested tens of levels deep
+		operators,    ///< long expressions of built-in and user-defined operators
+		literals,     ///< numbers, characters and short strings with escapes
+		long_strings, ///< multi-line strings of a few kilobytes
+		unicode,      ///< names out of ASCII
+	};
+
+	/// Every style, \c mixed first
+	std::span<corpus_style const> corpus_styles() noexcept;
+
+	std::string_view name(corpus_style style) noexcept;
+
+	/// @return The style named @p name, if there is one
+	std::optional<corpus_style> find_corpus_style(std::string_view name) noexcept;
+
+	/// Generates a rulang text of at least @p size bytes, made of whole lines.
+	/// The same arguments give the same text on every machine
+	std::string make_corpus(corpus_style style, size_t size, uint64_t seed = 1u);
+}
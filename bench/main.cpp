@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <memory_resource>
+#include <ranges>
+#include <string>
+#include <vector>
+#include "../src/lexer.hpp"
+#include "../src/lexer/stages.hpp"
+#include "../src/lexer/token_buffer.hpp"
+#include "../src/parser.hpp"
+#include "corpus.hpp"
+
+/// Usage: bench_rulang [bytes [style...]]
+/// Lexes and parses a generated text of each style, every style by default,
+/// and prints the throughput of each step as JSON
+namespace
+{
+	struct measurement
+	{
+		std::string_view name;
+		size_t tokens;
+		double seconds;
+	};
+
+	size_t count_tokens(Ru::lexer::token_generator tokens)
+	{
+		auto count = 0uz;
+		for (auto const& tok : tokens)
+			count += tok.id != Ru::lexer::id::none;
+		return count;
+	}
+
+	size_t count_tokens(Ru::lexer::batch_generator batches)
+	{
+		auto count = 0uz;
+		for (auto const& batch : batches)
+			for (auto const& tok : batch)
+				count += tok.id != Ru::lexer::id::none;
+		return count;
+	}
+
+	template <class Fn>
+	measurement measure(std::string_view name, Fn&& run)
+	{
+		auto const start = std::chrono::steady_clock::now();
+		auto const tokens = run();
+		return {name, tokens, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count()};
+	}
+
+	Ru::lexer::token_generator replay(std::vector<Ru::lexer::Token> const& tokens) noexcept
+	{
+		for (auto const& tok : tokens)
+			co_yield tok;
+	}
+
+	/// Runs each stage of \c lex_staged alone, over the tokens the stages before it gave
+	void measure_stages(std::string_view input, std::vector<measurement>& out)
+	{
+		auto tokens = std::vector<Ru::lexer::Token>();
+		for (auto const& tok : Ru::lexer::lex_raw(input))
+			tokens.push_back(tok);
+
+		auto interners = Ru::lexer::Interners();
+		auto next = std::vector<Ru::lexer::Token>();
+		for (auto const& stage : Ru::lexer::lex_stages())
+		{
+			next.clear();
+			next.reserve(tokens.size());
+			out.push_back(measure(stage.name, [&]
+			{
+				for (auto const& tok : stage.apply(replay(tokens), interners))
+					next.push_back(tok);
+				return size_t(std::ranges::count_if(next, [](auto const& tok) { return tok.id != Ru::lexer::id::none; }));
+			}));
+			std::swap(tokens, next);
+		}
+	}
+
+	/// The most lines \c parse_lines parses one by one
+	constexpr size_t max_snippets = 100'000u;
+
+	std::vector<measurement> measure_all(std::string_view input)
+	{
+		auto result = std::vector<measurement>();
+		result.push_back(measure("lex_raw", [&] { return count_tokens(Ru::lexer::lex_raw(input)); }));
+		measure_stages(input, result);
+		result.push_back(measure("lex_staged", [&] { return count_tokens(Ru::lexer::lex_staged(input)); }));
+		result.push_back(measure("lex_staged_pooled", [&]
+		{
+			auto frames = std::pmr::unsynchronized_pool_resource();
+			auto const pooled = Ru::frame_resource_scope(&frames);
+			return count_tokens(Ru::lexer::lex_staged(input));
+		}));
+		result.push_back(measure("lex", [&] { return count_tokens(Ru::lexer::lex(input)); }));
+		result.push_back(measure("lex_batched", [&] { return count_tokens(Ru::lexer::lex_batched(input)); }));
+		result.push_back(measure("lex_parallel", [&] { return count_tokens(Ru::lexer::lex_parallel(input)); }));
+		result.push_back(measure("lex_pipelined", [&]
+		{
+			auto operators = Ru::lexer::OperatorTable();
+			auto interners = Ru::lexer::Interners();
+			return count_tokens(Ru::lexer::lex_pipelined(input, operators, interners));
+		}));
+
+		auto const tokens = Ru::lexer::TokenBuffer(Ru::lexer::lex_batched(input));
+		result.push_back(measure("parse", [&]
+		{
+			auto const ast = Ru::parse::parse(tokens);
+			return tokens.size();
+		}));
+
+		result.push_back(measure("parse_parallel", [&]
+		{
+			auto const ast = Ru::parse::parse_parallel(tokens);
+			return tokens.size();
+		}));
+
+		result.push_back(measure("lex_parse_streamed", [&]
+		{
+			auto const ast = Ru::parse::parse(Ru::lexer::lex_batched(input));
+			return tokens.size();
+		}));
+
+		// many small parses, as of the lines of a REPL, where setting a parse up would cost the most
+		auto lines = std::vector<Ru::lexer::TokenBuffer>();
+		for (auto const line : std::views::split(input, '\n'))
+		{
+			if (lines.size() == max_snippets) break;
+			lines.emplace_back(Ru::lexer::lex_batched(std::string_view(line)));
+		}
+		result.push_back(measure("parse_lines", [&]
+		{
+			auto count = 0uz;
+			for (auto const& line : lines)
+			{
+				auto const ast = Ru::parse::parse(line);
+				count += line.size();
+			}
+			return count;
+		}));
+		return result;
+	}
+
+	void print(std::string_view style, size_t bytes, std::vector<measurement> const& results, bool last)
+	{
+		std::cout << std::format("    {{\"style\": \"{}\", \"bytes\": {}, \"results\": [\n", style, bytes);
+		for (auto i = 0uz; i != results.size(); ++i)
+		{
+			auto const& [name, tokens, seconds] = results[i];
+			std::cout << std::format(
+				"      {{\"name\": \"{}\", \"tokens\": {}, \"seconds\": {:.6f}, \"mb_per_s\": {:.2f}, \"tokens_per_s\": {:.0f}}}{}\n",
+				name, tokens, seconds, double(bytes) / seconds / 1e6, double(tokens) / seconds,
+				i + 1u == results.size() ? "" : ",");
+		}
+		std::cout << "    ]}" << (last ? "" : ",") << '\n';
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	auto const size = argc > 1 ? std::stoull(argv[1]) : 64uz << 20;
+
+	auto styles = std::vector<Ru::bench::corpus_style>();
+	for (auto i = 2; i < argc; ++i)
+		if (auto const style = Ru::bench::find_corpus_style(argv[i])) styles.push_back(*style);
+		else
+		{
+			std::cerr << "Unknown corpus style " << argv[i] << '\n';
+			return 1;
+		}
+	if (styles.empty())
+	{
+		auto const all = Ru::bench::corpus_styles();
+		styles.assign(all.begin(), all.end());
+	}
+
+	std::cout << std::format("{{\n  \"size\": {},\n  \"corpora\": [\n", size);
+	for (auto i = 0uz; i != styles.size(); ++i)
+	{
+		auto const input = Ru::bench::make_corpus(styles[i], size);
+		print(Ru::bench::name(styles[i]), input.size(), measure_all(input), i + 1u == styles.size());
+	}
+	std::cout << "  ]\n}\n";
+}
@@ -1,5 +1,7 @@
 #pragma once
+#include <memory>
 #include <utility>
+#include <vector>
 #include "../lexer.hpp"
 #include "../util.hpp"
 
@@ -11,10 +13,16 @@ namespace Ru::ast
 	{
 		enum class Type
 		{
-			simple, right, left, apply, binary, braced, left_braced, right_braced, ternary, multiple,
+			simple, right, left, apply, binary, braced, left_braced, right_braced, ternary, multiple, error,
 		};
 
-		using ptr_type = std::unique_ptr<Expression>;
+		/// Deletes a node as the type it was made of, the nodes have no virtual destructor
+		struct deleter
+		{
+			void operator()(Expression* expr) const noexcept;
+		};
+
+		using ptr_type = std::unique_ptr<Expression, deleter>;
 		using ptr = _Nonnull ptr_type;
 		using mb_ptr = _Nullable ptr_type;
 
@@ -41,6 +49,7 @@ namespace Ru::ast
 				CASE(right_braced);
 				CASE(ternary);
 				CASE(multiple);
+				CASE(error);
 			}
 			std::unreachable();
 			#undef CASE
@@ -62,105 +71,151 @@ namespace Ru::ast
 				CASE(right_braced);
 				CASE(ternary);
 				CASE(multiple);
+				CASE(error);
 			}
 			std::unreachable();
 			#undef CASE
 		}
 
-		#define CHECK_FN static bool classof(_Nonnull const Expression* expr) {return expr->type == type}
-
-		struct simple : Expression
+		/// Makes a node of @p Node from its fields, in their order
+		template<class Node, class... Fields>
+		static ptr_type make(Fields&&... fields)
 		{
-			static constexpr inline auto type = Type::simple;
-			Token token = required;
-		};
+			auto const node = new Node{{}, std::forward<Fields>(fields)...};
+			static_cast<Expression*>(node)->_type = Node::type;
+			return ptr_type(node);
+		}
 
-		struct right : Expression
-		{
-			static constexpr inline auto type = Type::right;
-			ptr left = required;
-			Operator op = required;
-		};
+		#define CHECK_FN static bool classof(_Nonnull const Expression* expr) {return expr->type == type}
 
-		struct left : Expression
-		{
-			static constexpr inline auto type = Type::left;
-			Operator op = required;
-			ptr right = required;
-		};
+		struct simple;
+		struct right;
+		struct left;
+		struct apply;
+		struct binary;
+		struct braced;
+		struct left_braced;
+		struct right_braced;
+		struct ternary;
+		struct multiple;
+		struct error;
 
-		struct apply : Expression
-		{
-			static constexpr inline auto type = Type::apply;
-			ptr left = required;
-			ptr right = required;
-		};
+	protected: Type _type;
+	private: [[msvc::no_unique_address]]
+		Empty _type_addr;
+	public:
+		[[msvc::no_unique_address]]
+		RefProperty<&Expression::_type, &Expression::_type_addr> type;
 
-		struct binary : Expression
-		{
-			static constexpr inline auto type = Type::binary;
-			ptr left = required;
-			Operator op = required;
-			ptr right = required;
-		};
+	};
 
-		struct braced : Expression
-		{
-			static constexpr inline auto type = Type::braced;
-			Operator open = required;
-			ptr mid = required;
-			Token close = required;
-		};
+	struct Expression::simple : Expression
+	{
+		static constexpr inline auto type = Type::simple;
+		Token token = required;
+	};
 
-		struct left_braced : Expression
-		{
-			static constexpr inline auto type = Type::left_braced;
-			Operator open = required;
-			ptr mid = required;
-			Token close = required;
-			ptr right = required;
-		};
+	struct Expression::right : Expression
+	{
+		static constexpr inline auto type = Type::right;
+		ptr left = required;
+		Operator op = required;
+	};
 
-		struct right_braced : Expression
-		{
-			static constexpr inline auto type = Type::right_braced;
-			ptr left = required;
-			Operator open = required;
-			ptr mid = required;
-			Token close = required;
-		};
+	struct Expression::left : Expression
+	{
+		static constexpr inline auto type = Type::left;
+		Operator op = required;
+		ptr right = required;
+	};
 
-		struct ternary : Expression
-		{
-			static constexpr inline auto type = Type::ternary;
-			ptr left = required;
-			Operator open = required;
-			ptr mid = required;
-			Token close = required;
-			ptr right = required;
-		};
+	struct Expression::apply : Expression
+	{
+		static constexpr inline auto type = Type::apply;
+		ptr left = required;
+		ptr right = required;
+	};
 
-		struct multiple : Expression
-		{
-			static constexpr inline auto type = Type::multiple;
-			std::vector<Expression> expressions = required;
-		};
+	struct Expression::binary : Expression
+	{
+		static constexpr inline auto type = Type::binary;
+		ptr left = required;
+		Operator op = required;
+		ptr right = required;
+	};
 
-	protected: Type _type;
-	private: [[msvc::no_unique_address]]
-		Empty _type_addr;
-	public:
-		[[msvc::no_unique_address]]
-		RefProperty<&Expression::_type, &Expression::_type_addr> type;
+	struct Expression::braced : Expression
+	{
+		static constexpr inline auto type = Type::braced;
+		Operator open = required;
+		/// \c nullptr between empty braces
+		mb_ptr mid = required;
+		Token close = required;
+	};
+
+	struct Expression::left_braced : Expression
+	{
+		static constexpr inline auto type = Type::left_braced;
+		Operator open = required;
+		ptr mid = required;
+		Token close = required;
+		ptr right = required;
+	};
 
+	struct Expression::right_braced : Expression
+	{
+		static constexpr inline auto type = Type::right_braced;
+		ptr left = required;
+		Operator open = required;
+		/// \c nullptr between empty braces
+		mb_ptr mid = required;
+		Token close = required;
 	};
 
-	void i()
+	struct Expression::ternary : Expression
 	{
+		static constexpr inline auto type = Type::ternary;
+		ptr left = required;
+		Operator open = required;
+		ptr mid = required;
+		Token close = required;
+		ptr right = required;
+	};
 
-	}
+	struct Expression::multiple : Expression
+	{
+		static constexpr inline auto type = Type::multiple;
+		std::vector<ptr_type> expressions = required;
+	};
 
+	/// A part of a text with a syntax error, which the parser went on after
+	struct Expression::error : Expression
+	{
+		static constexpr inline auto type = Type::error;
+		/// The token the error is at
+		Token token = required;
+	};
 
+	inline void Expression::deleter::operator()(Expression* expr) const noexcept
+	{
+		#define CASE(n) case Type::n: delete static_cast<n*>(expr); return
 
+		switch (expr->_type)
+		{
+			CASE(simple);
+			CASE(right);
+			CASE(left);
+			CASE(apply);
+			CASE(binary);
+			CASE(braced);
+			CASE(left_braced);
+			CASE(right_braced);
+			CASE(ternary);
+			CASE(multiple);
+			CASE(error);
+		}
+		#undef CASE
+	}
 
+	using ExpressionPtr = Expression::ptr_type;
 }
\ No newline at end of file
@@ -1,7 +1,14 @@
 //created this because <boost/cobald/...> didn't want to link and <generator> is not available yet
 #pragma once
+#include <concepts>
 #include <coroutine>
-#include <expected>
+#include <cstddef>
+#include <exception>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 
 namespace Ru
@@ -11,36 +18,174 @@ namespace Ru
 		returned_generator_error() : logic_error("Running a returned generator") {};
 	};
 
+	namespace detail
+	{
+		/// Where the frames of the generators created on this thread come from, \c nullptr for the global \c operator \c new
+		inline thread_local std::pmr::memory_resource* frame_resource = nullptr;
+
+		/// Each frame starts with the resource it came from, so it goes back there whatever the thread's resource is then
+		inline constexpr size_t frame_header = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+		static_assert(frame_header >= sizeof(std::pmr::memory_resource*));
+	}
+
+	/// Makes the generators created on this thread while it lives take their frames from @p resource,
+	/// as a pool or an arena of a compilation. The resource has to outlive the frames and to be used by one thread at a time,
+	/// unless it is synchronized
+	class frame_resource_scope
+	{
+	public:
+		explicit frame_resource_scope(std::pmr::memory_resource* resource) noexcept
+			: previous(std::exchange(detail::frame_resource, resource))
+		{}
+
+		~frame_resource_scope() { detail::frame_resource = previous; }
+
+		frame_resource_scope(frame_resource_scope const&) = delete;
+		void operator=(frame_resource_scope const&) = delete;
+
+	private:
+		std::pmr::memory_resource* previous;
+	};
+
 	template <class yield_type>
 	struct generator;
 
+	/// \code co_yield elements_of(nested) \endcode yields every element of @p nested in place.
+	/// A nested generator of the same type is resumed directly by whoever takes the elements,
+	/// so an element costs one resume however deep the generators are nested
+	template <class Range>
+	struct elements_of
+	{
+		Range range;
+	};
+
+	template <class Range>
+	elements_of(Range&&) -> elements_of<Range&&>;
+
 	template <class yieldT>
 	struct generator_promise
 	{
 		using yield_type = yieldT;
 		using yield_ref = yieldT&&;
 		using yield_ptr = std::remove_reference_t<yieldT>*;
-		
+		using handle_type = std::coroutine_handle<generator_promise>;
+
 		generator<yield_type> get_return_object() noexcept;
-		std::suspend_never    initial_suspend() noexcept { return {}; }
-		std::suspend_always   final_suspend() noexcept { return {}; }
+		std::suspend_never initial_suspend() noexcept { return {}; }
+
+		/// A nested generator hands the control straight back to the one it is nested in
+		struct final_awaiter
+		{
+			bool await_ready() noexcept { return false; }
+			std::coroutine_handle<> await_suspend(handle_type finished) noexcept
+			{
+				auto& promise = finished.promise();
+				if (not promise._parent) return std::noop_coroutine();
+				promise._root->_active = promise._parent;
+				return promise._parent;
+			}
+			void await_resume() noexcept {}
+		};
+		final_awaiter final_suspend() noexcept { return {}; }
+
+		/// A finished generator has nothing yielded, the error is only made when it is run anyway
+		void return_void() noexcept { _yielded = nullptr; }
+		std::suspend_always yield_value(yield_ref value) { _root->_yielded = &value; return {}; }
+
+		/// Nests a generator. It has run up to its first element already, as every generator starts eagerly
+		struct nested_awaiter
+		{
+			generator<yield_type> nested;
+			generator_promise* parent;
 
-		void return_void() noexcept { _yielded = std::unexpected(std::make_exception_ptr(returned_generator_error())); }
-		std::suspend_always yield_value(yield_ref value) { _yielded = &value; return {}; }
+			bool await_ready() noexcept { return nested._promise.done(); }
+			void await_suspend(handle_type) noexcept
+			{
+				auto& child = nested._promise.promise();
+				auto& root = *parent->_root;
 
-		void unhandled_exception() noexcept { _yielded = std::unexpected(std::current_exception()); }
+				// the nested generator was the root of the ones it nested itself
+				for (auto at = child._active;; at = at.promise()._parent)
+				{
+					at.promise()._root = &root;
+					if (at == nested._promise) break;
+				}
+				child._parent = handle_type::from_promise(*parent);
+				root._active = child._active;
+				root._yielded = child._yielded;
+			}
+			void await_resume()
+			{
+				if (auto const& exception = nested._promise.promise()._exception) std::rethrow_exception(exception);
+			}
+		};
+
+		template <class Range>
+		nested_awaiter yield_value(elements_of<Range> nested)
+		{
+			if constexpr (std::same_as<std::remove_cvref_t<Range>, generator<yield_type>>)
+				return {std::move(nested.range), this};
+			else return {elements(std::forward<Range>(nested.range)), this};
+		}
+
+		void unhandled_exception() noexcept
+		{
+			_yielded = nullptr;
+			_exception = std::current_exception();
+		}
 		yield_ptr operator->()
-		{ 
-			if (not _yielded) std::rethrow_exception(_yielded.error()); 
-			return *_yielded;
+		{
+			if (not _yielded) rethrow();
+			return _yielded;
 		}
 		yield_ref operator*()
 		{
-			if (not _yielded) std::rethrow_exception(_yielded.error());
-			return std::forward<yield_type>(**_yielded);
+			if (not _yielded) rethrow();
+			return std::forward<yield_type>(*_yielded);
+		}
+
+		/// The generator to resume for the next element, the innermost nested one
+		handle_type active() const noexcept { return _active; }
+
+		static void* operator new(size_t size)
+		{
+			auto const resource = detail::frame_resource;
+			auto const block = resource
+				? resource->allocate(size + detail::frame_header, __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+				: ::operator new(size + detail::frame_header);
+			*static_cast<std::pmr::memory_resource**>(block) = resource;
+			return static_cast<std::byte*>(block) + detail::frame_header;
+		}
+
+		static void operator delete(void* frame, size_t size) noexcept
+		{
+			auto const block = static_cast<std::byte*>(frame) - detail::frame_header;
+			if (auto const resource = *reinterpret_cast<std::pmr::memory_resource**>(block))
+				resource->deallocate(block, size + detail::frame_header, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+			else ::operator delete(block, size + detail::frame_header);
 		}
+
 	private:
-		std::expected<yield_ptr, std::exception_ptr> _yielded;
+		[[noreturn]] void rethrow() const
+		{
+			if (_exception) std::rethrow_exception(_exception);
+			throw returned_generator_error();
+		}
+
+		template <class Range>
+		static generator<yield_type> elements(Range&& range)
+		{
+			for (auto&& element : range)
+				co_yield yield_type(element);
+		}
+
+		/// Set in the root, the generator the elements are taken from
+		yield_ptr _yielded = nullptr;
+		handle_type _active;
+		/// The outermost generator, which is this one unless it is nested
+		generator_promise* _root = this;
+		handle_type _parent;
+		std::exception_ptr _exception;
 	};
 
 	template <class yieldT>
@@ -49,7 +194,7 @@ namespace Ru
 		using yield_type = yieldT;
 		using promise_type = generator_promise<yield_type>;
 		using handle_type = std::coroutine_handle<promise_type>;
-		friend generator<yield_type> promise_type::get_return_object() noexcept;
+		friend promise_type;
 
 		void swap(generator& other) noexcept
 		{
@@ -68,7 +213,7 @@ namespace Ru
 			decltype(auto) operator*() const { return *self->_promise.promise(); }
 			explicit operator bool() const { return self and not self->_promise.done(); }
 			bool operator !=(iterator) const { return (bool) *this; }
-			decltype(auto) operator++() noexcept { self->_promise(); return *this; }
+			decltype(auto) operator++() noexcept { self->_promise.promise().active().resume(); return *this; }
 			void operator++(int) { ++*this; }
 			explicit iterator(generator& self) : self(&self) { }
 			explicit iterator() : self(nullptr) {}
@@ -92,6 +237,7 @@ namespace Ru
 	{
 		generator<yield_type> g;
 		g._promise = generator<yield_type>::handle_type::from_promise(*this);
+		_active = g._promise;
 		return g;
 	}
 }
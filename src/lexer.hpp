@@ -1,6 +1,10 @@
 #pragma once
 #include <string_view>
 #include <ostream>
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
 #include <boost/io/quoted.hpp>
 #include <boost/locale/encoding_utf.hpp>
 #include "generator.hpp"
@@ -18,6 +22,7 @@ namespace Ru::lexer
 		error_unclosed_string,
 		error_name_unclosed_string,
 		error_standalone_quo,
+		error_bad_utf8,
 		error_bad_int,
 
 		br_open,     // (
@@ -152,15 +157,59 @@ namespace Ru::lexer
 		return (int)_0 <=> (int)_1;
 	}
 
-	inline dir associativity(prec prec)
+	constexpr dir associativity(prec prec)
 	{
 		return (dir)(bool)(std::to_underlying(prec) & 1u << 1);
 	}
-	inline dir unary_side(prec prec)
+	constexpr dir unary_side(prec prec)
 	{
 		return (dir)(bool)(std::to_underlying(prec) & 1u << 0);
 	}
 
+	/// @brief The exact value of a number literal, decoded by the lexer
+	struct Number
+	{
+		enum class kind : uint8_t
+		{
+			none,        ///< not a number
+			integer,     ///< fits 64 bits, in \c integer
+			big_integer, ///< does not fit 64 bits, in \c limbs
+			floating,    ///< has a fraction or an exponent, correctly rounded in \c floating
+		};
+
+		kind kind = kind::none;
+		/// The number of \c limbs of a big integer
+		uint32_t size = 0;
+		union
+		{
+			uint64_t integer = 0;
+			double floating;
+			/// Little-endian 64-bit limbs, kept in the \c Interners of the compilation as the tokens are classified
+			uint64_t const* limbs;
+		};
+
+		/// @return The limbs of any integer, the only one of a small one
+		std::span<uint64_t const> digits() const noexcept
+		{
+			if (kind == kind::big_integer) return {limbs, size};
+			if (kind == kind::integer) return {&integer, 1u};
+			return {};
+		}
+
+		friend bool operator==(Number const& _0, Number const& _1) noexcept
+		{
+			if (_0.kind != _1.kind) return false;
+			if (_0.kind == kind::floating) return _0.floating == _1.floating;
+			return std::ranges::equal(_0.digits(), _1.digits());
+		}
+	};
+
+	/// @brief The spelling of a name as a number, given by an \c Interner; equal spellings have equal symbols
+	enum class Symbol : uint32_t
+	{
+		none, ///< not a name
+	};
+
 	/// @brief A struct containing a Token metainfo
 	struct Token
 	{
@@ -168,18 +217,21 @@ namespace Ru::lexer
 		id id = required;
 		/// Operator precedence template
 		prec prec = prec::intern;
-		/// A text Token representation
+		/// The operator's index in the module's OperatorTable, 0 for other tokens
+		uint16_t operator_index = 0;
+		/// The symbol of a name's spelling in \c Interners::names, of a string or a character literal's decoded value
+		/// in \c Interners::literals, \c Symbol::none for the other tokens
+		Symbol symbol = Symbol::none;
+		/// A text Token representation, pointing into the lexed text; a LineTable tells its line and column
 		std::string_view as_text = required;
-		/// line's number from 0
-		intptr_t line = required;
-		/// utf8-column's number from 0
-		intptr_t column = required;
 		/// The Token's prefix ('0x'-like thing) size
 		intptr_t prefix = 0;
 		/// The Token's postfix size
 		intptr_t postfix = 0;
 		/// That e+123 thing in numbers; quotation marks count for strings
 		int64_t shift = 0;
+		/// The value of a number
+		Number number = {};
 
 
 		explicit operator bool() const noexcept {return id != id::none; }
@@ -190,11 +242,7 @@ namespace Ru::lexer
 				<< "Token{.id = (id)"
 				<< (unsigned)self.id
 				<< ", .as_text = "
-				<< boost::io::quoted((std::string)self.as_text)
-			    << ", .line = "
-				<< self.line
-				<< ", .column = "
-				<< self.column;
+				<< boost::io::quoted((std::string)self.as_text);
 
 			if (self.prefix != 0) out
 				<< ", .prefix = "
@@ -213,25 +261,134 @@ namespace Ru::lexer
 		}
 	};
 
+	static_assert(std::is_trivially_copyable_v<Token>, "The tokens are copied around by the stages");
+
 	constexpr inline Token none{
 		.id = id::none,
 		.as_text = {},
-		.line = 0,
-		.column = 0,
 	};
 
 	constexpr inline Token skip{
 		.id = id::skip,
 		.as_text = {},
-		.line = 0,
-		.column = 0,
 	};
 
+	class OperatorTable;
+	struct Interners;
+
 	using token_generator = generator<Token const&>;
+	/// A block of tokens, valid until the generator that yielded it is resumed
+	using token_batch = std::span<Token const>;
+	using batch_generator = generator<token_batch const&>;
+
+	/// The default number of tokens in a batch
+	inline constexpr size_t default_batch_size = 256;
+
+	/// Performs a primary splitting the text
+	/// @return A sequence of raw tokens, with no keywords, indents and precedences resolved
+	token_generator lex_raw (
+	    std::string_view input ///< An UTF-8 text to lex
+	) noexcept;
 
 	/// Parses a text into a sequence of tokens
 	/// @return A sequence of tokens to parse
 	token_generator lex (
-	    std::u32string_view input ///< A sequence of lines to lex
+	    std::string_view input ///< An UTF-8 text to lex
+	) noexcept;
+
+	/// Parses a text into a sequence of tokens, interning its operators, names and literals
+	/// @return A sequence of tokens to parse
+	token_generator lex (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    OperatorTable& operators, ///< The operators of the module, the text's operators are added to
+	    Interners& interners ///< The names and literals of the compilation, the text's are added to
 	) noexcept;
+
+	/// Parses a text into a sequence of tokens by a chain of single-purpose stages
+	/// @return The same sequence as \c lex gives, produced the slow but obvious way
+	token_generator lex_staged (
+	    std::string_view input ///< An UTF-8 text to lex
+	) noexcept;
+
+	/// Parses a text into a sequence of tokens by a chain of single-purpose stages, interning its names and literals
+	token_generator lex_staged (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    Interners& interners ///< The names and literals of the compilation, the text's are added to
+	) noexcept;
+
+	/// Parses a text into a sequence of token blocks, the same tokens as \c lex gives
+	/// @return A sequence of non-empty blocks of at least @p batch_size tokens each, the last one may be shorter
+	batch_generator lex_batched (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    size_t batch_size = default_batch_size ///< The least number of tokens in a block
+	) noexcept;
+
+	/// Parses a text into a sequence of token blocks, interning its operators, names and literals
+	batch_generator lex_batched (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    OperatorTable& operators, ///< The operators of the module, the text's operators are added to
+	    Interners& interners, ///< The names and literals of the compilation, the text's are added to
+	    size_t batch_size = default_batch_size ///< The least number of tokens in a block
+	) noexcept;
+
+	/// The default number of bytes a chunk of \c lex_parallel starts with
+	inline constexpr size_t default_chunk_size = 1uz << 20;
+
+	/// Parses a text into a sequence of token blocks, lexing chunks of it that end at line ends on a thread pool.
+	/// A token running across chunks, as a multi-line string, has the chunk after it lexed again in order
+	/// @return The same tokens as \c lex gives, in blocks of at least @p batch_size tokens, the last one may be shorter
+	batch_generator lex_parallel (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    OperatorTable& operators, ///< The operators of the module, the text's operators are added to
+	    Interners& interners, ///< The names and literals of the compilation, the chunks add the text's to at once
+	    size_t chunk_size = default_chunk_size, ///< The least number of bytes in a chunk, the last one may be shorter
+	    size_t batch_size = default_batch_size ///< The least number of tokens in a block
+	) noexcept;
+
+	/// Parses a text into a sequence of token blocks, lexing chunks of it on a thread pool
+	batch_generator lex_parallel (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    size_t chunk_size = default_chunk_size, ///< The least number of bytes in a chunk, the last one may be shorter
+	    size_t batch_size = default_batch_size ///< The least number of tokens in a block
+	) noexcept;
+
+	/// The default number of blocks \c lex_pipelined lexes ahead
+	inline constexpr size_t default_ring_blocks = 64;
+
+	/// Parses a text into a sequence of token blocks lexed ahead on a thread of their own.
+	/// The blocks go through a bounded ring, so the lexer is at most @p ring_blocks blocks ahead of the caller
+	/// \note @p operators belongs to the lexing thread until the sequence ends or is destroyed
+	/// @return The same tokens as \c lex gives, in blocks of at least @p batch_size tokens, the last one may be shorter
+	batch_generator lex_pipelined (
+	    std::string_view input, ///< An UTF-8 text to lex
+	    OperatorTable& operators, ///< The operators of the module, the text's operators are added to
+	    Interners& interners, ///< The names and literals of the compilation, the text's are added to
+	    size_t ring_blocks = default_ring_blocks, ///< The most blocks lexed and not yet taken
+	    size_t batch_size = default_batch_size ///< The least number of tokens in a block
+	) noexcept;
+
+	/// Groups a sequence of tokens into blocks
+	batch_generator batched (
+	    token_generator tokens,
+	    size_t batch_size = default_batch_size ///< The number of tokens in a block, the last one may be shorter
+	) noexcept;
+
+	/// Flattens a sequence of token blocks
+	token_generator unbatched (batch_generator batches) noexcept;
+
+	/// Makes a batch stage of a function that appends to a buffer the tokens it makes of each block
+	template <class Fn>
+	batch_generator map_batches (
+	    batch_generator batches,
+	    Fn fn ///< Called as fn(token_batch, std::vector<Token>&)
+	)
+	{
+		auto buffer = std::vector<Token>{};
+		for (auto const& batch : batches)
+		{
+			buffer.clear();
+			fn(batch, buffer);
+			if (not buffer.empty()) co_yield token_batch(buffer);
+		}
+	}
 }
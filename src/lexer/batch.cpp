@@ -0,0 +1,26 @@
+#include "../lexer.hpp"
+
+namespace Ru::lexer
+{
+	batch_generator batched(token_generator tokens, size_t batch_size) noexcept
+	{
+		auto buffer = std::vector<Token>{};
+		buffer.reserve(batch_size);
+		for (auto const& tok : tokens)
+		{
+			buffer.push_back(tok);
+			if (buffer.size() < batch_size) continue;
+
+			co_yield token_batch(buffer);
+			buffer.clear();
+		}
+		if (not buffer.empty()) co_yield token_batch(buffer);
+	}
+
+	token_generator unbatched(batch_generator batches) noexcept
+	{
+		for (auto const& batch : batches)
+			for (auto const& tok : batch)
+				co_yield tok;
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <utility>
+#include "char_class_tables.hpp"
+
+namespace Ru::lexer::chars
+{
+	/// Character classes the lexer tells apart, as bit flags
+	enum class [[clang::flag_enum]] char_class : uint8_t
+	{
+		none   = 0,
+		start  = 1u << 0, ///< may start a name: XID_Start and _
+		cont   = 1u << 1, ///< may continue a name: XID_Continue
+		punct  = 1u << 2, ///< may be a part of an operator
+		graph  = 1u << 3, ///< may be a part of an explicit operator \example '+-
+		xdigit = 1u << 4, ///< a hexadecimal digit, ASCII only
+	};
+
+	constexpr char_class operator|(char_class _0, char_class _1) noexcept
+	{
+		return char_class(std::to_underlying(_0) | std::to_underlying(_1));
+	}
+
+	/// @return Whether @p set has any of @p classes
+	constexpr bool has(char_class set, char_class classes) noexcept
+	{
+		return (std::to_underlying(set) & std::to_underlying(classes)) != 0u;
+	}
+
+	/// The classes of ASCII, the same on every machine and in every locale.
+	/// \note _ " ' , ; # ( ) have their own tokens and are never a part of an operator
+	constexpr inline auto ascii = []
+	{
+		using enum char_class;
+		std::array<char_class, 0x80> table{};
+		for (unsigned ch = 0; ch != table.size(); ++ch)
+		{
+			bool const lower = ch >= 'a' and ch <= 'z', upper = ch >= 'A' and ch <= 'Z', digit = ch >= '0' and ch <= '9';
+			bool const own_token = ch == '_' or ch == '"' or ch == '\'' or ch == ',' or ch == ';' or ch == '#' or ch == '(' or ch == ')';
+			bool const op = ch > ' ' and ch < 0x7F and not lower and not upper and not digit and not own_token;
+
+			if (lower or upper or ch == '_') table[ch] = table[ch] | start;
+			if (lower or upper or digit or ch == '_') table[ch] = table[ch] | cont;
+			if (op) table[ch] = table[ch] | punct;
+			if (lower or upper or digit or op) table[ch] = table[ch] | graph;
+			if (digit or ch >= 'a' and ch <= 'f' or ch >= 'A' and ch <= 'F') table[ch] = table[ch] | xdigit;
+		}
+		return table;
+	}();
+
+	/// @return The classes of a code point, ASCII by a table lookup and the rest by two
+	constexpr char_class classify(char32_t ch) noexcept
+	{
+		if (ch < ascii.size()) return ascii[ch];
+		if (ch > 0x10FFFFu) return char_class::none;
+		return char_class(tables::blocks[tables::index[ch >> tables::block_bits]][ch & ((1u << tables::block_bits) - 1u)]);
+	}
+}
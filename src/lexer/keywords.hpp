@@ -0,0 +1,144 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include "../lexer.hpp"
+
+namespace Ru::lexer::keywords
+{
+	struct entry
+	{
+		std::string_view text;
+		id id = id::none;
+		prec prec = prec::intern;
+	};
+
+	/// A collision-free hash table of a fixed set of words, built at compile time.
+	/// A word is checked by its length and its first byte first, so most identifiers
+	/// are rejected without hashing
+	template <size_t slot_count>
+	class PerfectHash
+	{
+		static_assert(slot_count != 0u and (slot_count & (slot_count - 1u)) == 0u, "The slot count is a power of 2");
+
+	public:
+		/// The longest word a table takes
+		static constexpr size_t max_length = 15u;
+
+		template <size_t entry_count>
+		consteval explicit PerfectHash(std::array<entry, entry_count> const& entries)
+		{
+			static_assert(entry_count <= slot_count);
+			for (auto const& word : entries)
+			{
+				if (word.text.empty() or word.text.size() > max_length) throw "A keyword is empty or too long";
+				prefilter[(unsigned char)word.text.front()] |= uint16_t(1u << word.text.size());
+			}
+
+			for (seed = 1u; ; ++seed)
+			{
+				auto taken = std::array<bool, slot_count>{};
+				auto collided = false;
+				for (auto const& word : entries)
+					collided = collided or std::exchange(taken[slot(word.text, seed)], true);
+				if (not collided) break;
+				if (seed == 1u << 16) throw "No perfect hash seed is found, the slot count is too small";
+			}
+
+			for (auto const& word : entries)
+				slots[slot(word.text, seed)] = word;
+		}
+
+		/// @return The id and the precedence of a word from the table
+		constexpr std::optional<std::pair<id, prec>> find(std::string_view text) const noexcept
+		{
+			if (text.empty() or text.size() > max_length) return std::nullopt;
+			if ((prefilter[(unsigned char)text.front()] >> text.size() & 1u) == 0u) return std::nullopt;
+
+			auto const& found = slots[slot(text, seed)];
+			if (found.text != text) return std::nullopt;
+			return std::pair{found.id, found.prec};
+		}
+
+	private:
+		/// FNV-1a, seeded
+		static constexpr size_t slot(std::string_view text, uint32_t seed) noexcept
+		{
+			auto hash = 0x811C9DC5u ^ seed * 0x9E3779B9u;
+			for (auto const ch : text)
+				hash = (hash ^ (unsigned char)ch) * 0x01000193u;
+			return (hash ^ hash >> 16) & (slot_count - 1u);
+		}
+
+		uint32_t seed = 0u;
+		std::array<entry, slot_count> slots{};
+		/// The lengths of the words by their first byte, as bit sets
+		std::array<uint16_t, 256> prefilter{};
+	};
+
+	#define kw(word, precedence) entry{ #word, id::kw_ ## word, prec::precedence }
+	inline constexpr auto identifiers = PerfectHash<64>(std::array{
+		kw(in, cmp),
+		kw(out, intern),
+		kw(mut, intern),
+		kw(const, intern),
+		kw(return, while_),
+		kw(yield, while_),
+		kw(type, while_),
+		kw(trait, while_),
+		kw(class, while_),
+		kw(fn, while_),
+		kw(module, while_),
+		kw(impl, intern),
+		kw(use, intern),
+		kw(with, intern),
+		kw(when, intern),
+		kw(as, intern),
+		kw(not, not_),
+		kw(then, and_),
+		kw(else, or_),
+		kw(and, and_),
+		kw(or, or_),
+		kw(for, and_),
+		kw(while, while_),
+		kw(_, intern),
+		kw(priv, intern),
+		kw(pub, intern),
+		kw(match, and_),
+		kw(is, tree),
+		kw(by, tree),
+		kw(prp, tree),
+	});
+	#undef kw
+
+	#define kwop(op, name, precedence) entry{ #op, id::op_ ## name, prec::precedence }
+	inline constexpr auto operators = PerfectHash<16>(std::array{
+		kwop(:= , init, other),
+		kwop(=> , fn, other),
+		kwop( ! , move, intern),
+		kwop(..., dots, intern),
+		kwop( = , exchange, exchange),
+		kwop( & , ref, intern),
+		kwop( . , dot, intern),
+		kwop( | , either, either),
+		kwop( : , pair, pair),
+	});
+	#undef kwop
+}
+
+namespace Ru::lexer
+{
+	/// @return The id and the precedence of a keyword identifier
+	constexpr std::optional<std::pair<id, prec>> find_keyword(std::string_view name) noexcept
+	{
+		return keywords::identifiers.find(name);
+	}
+
+	/// @return The id and the precedence of a keyword operator
+	constexpr std::optional<std::pair<id, prec>> find_keyword_operator(std::string_view op) noexcept
+	{
+		return keywords::operators.find(op);
+	}
+}
@@ -1,23 +1,10 @@
-#include <unordered_set>
 #include "../lexer.hpp"
+#include "stages.hpp"
 
 namespace Ru::lexer
 {
-	static token_generator apply_none(token_generator tokens) noexcept
-	{
-		for (auto const& tok : tokens)
-		{
-			co_yield tok;
-		}
-		co_yield none;
-	}
-
-
-	/// Performs a primary splitting the text
-	extern token_generator lex_raw(std::string_view input) noexcept;
-
-	/// Detects the keywords and changes the ids of the keyword identifiers tokens
-	static token_generator identifiers(token_generator tokens) noexcept
+	/// Detects the keywords and changes the ids of the keyword identifiers tokens, the other names get their symbols
+	static token_generator identifiers(token_generator tokens, Interners& interners) noexcept
 	{
 		for (auto const& tok: tokens)
 		{
@@ -27,55 +14,46 @@ namespace Ru::lexer
 				continue;
 			}
 
-			using namespace std::string_view_literals;
-			#define kw(word, precedence) { #word ## sv , { id::kw_ ## word, prec::precedence } }
-			static auto const keywords = std::unordered_map<std::string_view, std::pair<id, prec>>
+			if (auto const found = find_keyword(tok.as_text); not found)
 			{
-				kw(in, cmp),
-				kw(out, intern),
-				kw(mut, intern),
-				kw(const, intern),
-				kw(return, while_),
-				kw(yield, while_),
-				kw(type, while_),
-				kw(trait, while_),
-				kw(class, while_),
-				kw(fn, while_),
-				kw(module, while_),
-				kw(impl, intern),
-				kw(use, intern),
-				kw(with, intern),
-				kw(when, intern),
-				kw(as, intern),
-				kw(not, not_),
-				kw(then, and_),
-				kw(else, or_),
-				kw(and, and_),
-				kw(or, or_),
-				kw(for, and_),
-				kw(while, while_),
-				kw(_, intern),
-				kw(priv, intern),
-				kw(pub, intern),
-				kw(match, and_),
-				kw(is, tree),
-				kw(by, tree),
-				kw(prp, tree),
-			};
-			#undef kw
-
-			auto const found = keywords.find(tok.as_text);
-			if (keywords.end() == found) co_yield tok;
+				auto token_copy = tok;
+				token_copy.symbol = interners.names.intern(tok.as_text);
+				co_yield token_copy;
+			}
 			else
 			{
 				auto token_copy = tok;
-				token_copy.id = found->second.first;
-				token_copy.prec = found->second.second;
+				token_copy.id = found->first;
+				token_copy.prec = found->second;
 				co_yield token_copy;
 			}
 		}
 	}
 
+	/// Gives the string and character literals their decoded values, the big integers their limbs
+	static token_generator literal_values(token_generator tokens, Interners& interners) noexcept
+	{
+		for (auto const& tok: tokens)
+		{
+			if (tok.id == id::number and tok.number.kind == Number::kind::big_integer)
+			{
+				auto token_copy = tok;
+				keep_limbs(token_copy, interners.limbs);
+				co_yield token_copy;
+				continue;
+			}
+			if (tok.id != id::string and tok.id != id::character)
+			{
+				co_yield tok;
+				continue;
+			}
+
+			auto token_copy = tok;
+			token_copy.symbol = intern_literal(literal_body(tok), interners.literals);
+			co_yield token_copy;
+		}
+	}
+
 	/// Detects operator tokens that end with '.' and split them into two
 	static token_generator dot_at_right(token_generator tokens) noexcept
 	{
@@ -96,8 +74,6 @@ namespace Ru::lexer
 			co_yield Token{
 				.id = id::op_dot,
 				.as_text = {tok.as_text.end() - 1, tok.as_text.end()},
-				.line = tok.line,
-				.column = tok.column - 1 + intptr_t(tok.as_text.length()),
 			};
 		}
 	}
@@ -110,7 +86,7 @@ namespace Ru::lexer
 			if (tok.id != id::operator_
 			or tok.as_text.front() != '.'
 			or tok.as_text.size() == 1u
-			or tok.as_text.end()[1] == '.')
+			or tok.as_text[1] == '.')
 			{
 				co_yield tok;
 				continue;
@@ -118,12 +94,9 @@ namespace Ru::lexer
 
 			auto token_copy = tok;
 			token_copy.as_text = tok.as_text.substr(1u, tok.as_text.size());
-			token_copy.column++;
 			co_yield Token{
 				.id = id::op_dot,
 				.as_text = tok.as_text.substr(0u, 1u),
-				.line = tok.line,
-				.column = tok.column,
 			};
 			co_yield token_copy;
 		}
@@ -140,37 +113,19 @@ namespace Ru::lexer
 				continue;
 			}
 
-			using namespace std::string_view_literals;
-			#define kwop(op, name, precedence) { #op ## sv, {id::op_ ## name, prec::precedence}}
-			static auto const keywords = std::unordered_map<std::string_view, std::pair<id, prec>>
-			{
-				kwop(:= , init, other),
-				kwop(=> , fn, other),
-				kwop( ! , move, intern),
-				kwop(..., dots, intern),
-				kwop( = , exchange, exchange),
-				kwop( & , ref, intern),
-				kwop( . , dot, intern),
-				kwop( | , either, either),
-				kwop( : , pair, pair),
-			};
-			#undef kwop
-
 			auto token_copy = tok;
 
-			if (auto const at = keywords.find(tok.as_text);
-			    at != keywords.end()
-				)
+			if (auto const found = find_keyword_operator(tok.as_text))
 			{
-				token_copy.id = at->second.first;
-				token_copy.prec = at->second.second;
+				token_copy.id = found->first;
+				token_copy.prec = found->second;
 			}
 
 			co_yield token_copy;
 		}
 	}
 
-	static token_generator noexpl(token_generator tokens) noexcept
+	static token_generator noexpl(token_generator tokens, Interners& interners) noexcept
 	{
 		for (auto const& tok: tokens)
 		{
@@ -178,6 +133,7 @@ namespace Ru::lexer
 			{
 				auto copy = tok;
 				copy.id = id::identifier;
+				copy.symbol = interners.names.intern(tok.as_text);
 				co_yield copy;
 				continue;
 			}
@@ -192,30 +148,32 @@ namespace Ru::lexer
 		}
 	}
 
-	constexpr static auto mix(id left, id right, id result)
+	/// Merges adjacent @p left and @p right tokens into one @p result token
+	static token_generator mix(token_generator tokens, id left, id right, id result) noexcept
 	{
-		return [=] (token_generator tokens) noexcept -> token_generator
+		auto prev = none;
+		auto has_prev = false;
+		for (auto const& tok : tokens)
 		{
-			Token curr = none, prev = none;
-			for (auto const& tok : std::move(tokens) ->* apply_none)
+			if (has_prev
+			    and prev.id == left
+			    and tok.id == right
+			    and tok.as_text.data() == prev.as_text.data() + prev.as_text.size())
 			{
-				prev = curr;
-				curr = tok;
-
-				if (prev.id == left
-				    and curr.id == right
-				    and curr.as_text.data() == prev.as_text.data() + prev.as_text.size())
-				{
-					auto copy = curr;
-					copy.id = result;
-					copy.as_text = {prev.as_text.begin(), curr.as_text.end()};
-					copy.column = prev.column;
-					copy.prefix = prev.as_text.size();
-					co_yield curr;
-				}
-				else co_yield prev;
+				auto copy = tok;
+				copy.id = result;
+				copy.as_text = {prev.as_text.begin(), tok.as_text.end()};
+				copy.prefix = prev.as_text.size();
+				has_prev = false;
+				co_yield copy;
+				continue;
 			}
-		};
+
+			if (has_prev) co_yield prev;
+			prev = tok;
+			has_prev = true;
+		}
+		if (has_prev) co_yield prev;
 	}
 
 	extern token_generator precedence(token_generator tokens) noexcept;
@@ -229,6 +187,17 @@ namespace Ru::lexer
 		{
 			prev = curr;
 			curr = tok;
+			if (tok.id == id::none)
+			{
+				// the indents still open are closed at the end of the input
+				auto const dedent_tok = Token{
+					.id = id::dedent,
+					.prec = prec::close,
+					.as_text = {prev.as_text.data() + prev.as_text.size(), 0uz},
+				};
+				for (; indents.size() != 1u; indents.pop_back())
+					co_yield dedent_tok;
+			}
 			if (tok.id != id::newline)
 			{
 				co_yield tok;
@@ -293,19 +262,38 @@ namespace Ru::lexer
 		}
 	}
 
-	token_generator lex(std::string_view input) noexcept
+	std::span<lex_stage const> lex_stages() noexcept
+	{
+		// the stages that intern nothing leave the interners
+		#define RU_STAGE(stage) [](token_generator tokens, Interners&) noexcept { return stage(std::move(tokens)); }
+		static constexpr lex_stage stages[]
+		{
+			{"identifiers", identifiers},
+			{"literal_values", literal_values},
+			{"dot_at_right", RU_STAGE(dot_at_right)},
+			{"dot_at_left", RU_STAGE(dot_at_left)},
+			{"operators", RU_STAGE(operators)},
+			{"not_in", [](token_generator tokens, Interners&) noexcept { return mix(std::move(tokens), id::op_move, id::kw_in, id::not_in); }},
+			{"precedence", RU_STAGE(precedence)},
+			{"indents", RU_STAGE(indents)},
+			{"noexpl", noexpl},
+			{"invoke", RU_STAGE(invoke)},
+		};
+		#undef RU_STAGE
+		return stages;
+	}
+
+	token_generator lex_staged(std::string_view input, Interners& interners) noexcept
+	{
+		auto tokens = lex_raw(input);
+		for (auto const& stage : lex_stages())
+			tokens = stage.apply(std::move(tokens), interners);
+		return tokens;
+	}
+
+	token_generator lex_staged(std::string_view input) noexcept
 	{
-		return input
-			->* lex_raw
-			->* identifiers
-			->* dot_at_right
-			->* dot_at_left
-			->* operators
-			->* mix(id::op_move, id::kw_in, id::not_in)
-			->* precedence
-			->* indents
-			->* noexpl
-			->* invoke
-	    ;
+		auto interners = Interners();
+		co_yield elements_of(lex_staged(input, interners));
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <span>
+#include "../lexer.hpp"
+#include "operators.hpp"
+#include "stages.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		/// Every stage of \c lex_staged as one pass: the raw tokens are pulled one at a time
+		/// and pushed through the stages by plain calls
+		class FusedLexer
+		{
+		public:
+			FusedLexer(std::string_view input, OperatorTable& operators, Interners& interners) noexcept
+				: raw(input)
+				, stages(operators)
+				, interners(interners)
+			{}
+
+			/// Lexes raw tokens until at least @p count tokens come out of the last stage
+			/// @return false when the input is over and nothing came out
+			bool advance(size_t count = 1u)
+			{
+				stages.clear_output();
+				while (stages.output_size() < count)
+				{
+					if (not raw.done()) classify(raw.next(), interners, [this](Token const& tok) { stages.push(tok); });
+					else if (not stages.flush()) return stages.output_size() != 0u;
+				}
+				return true;
+			}
+
+			/// The tokens of the last \c advance
+			std::span<Token const> output() const noexcept { return stages.output(); }
+
+		private:
+			RawLexer raw;
+			FusedStages stages;
+			Interners& interners;
+		};
+	}
+
+	token_generator lex(std::string_view input, OperatorTable& operators, Interners& interners) noexcept
+	{
+		auto lexer = FusedLexer(input, operators, interners);
+		while (lexer.advance())
+			for (auto const& tok : lexer.output())
+				co_yield tok;
+	}
+
+	token_generator lex(std::string_view input) noexcept
+	{
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		auto lexer = FusedLexer(input, operators, interners);
+		while (lexer.advance())
+			for (auto const& tok : lexer.output())
+				co_yield tok;
+	}
+
+	batch_generator lex_batched(std::string_view input, OperatorTable& operators, Interners& interners, size_t batch_size) noexcept
+	{
+		auto lexer = FusedLexer(input, operators, interners);
+		while (lexer.advance(std::max(batch_size, 1uz)))
+			co_yield lexer.output();
+	}
+
+	batch_generator lex_batched(std::string_view input, size_t batch_size) noexcept
+	{
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		auto lexer = FusedLexer(input, operators, interners);
+		while (lexer.advance(std::max(batch_size, 1uz)))
+			co_yield lexer.output();
+	}
+}
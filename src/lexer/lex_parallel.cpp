@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <vector>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include "../lexer.hpp"
+#include "operators.hpp"
+#include "scan.hpp"
+#include "stages.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		/// A part of the text lexed on its own, as if a token started at its beginning
+		struct chunk
+		{
+			char const* from;
+			char const* stop;
+			/// The classified tokens that start in the chunk
+			std::vector<Token> tokens = {};
+			/// Where the last token of the chunk ends, past \c stop when it runs into the next chunks
+			char const* reached = nullptr;
+			std::future<void> lexed = {};
+		};
+
+		/// Lexes and classifies the raw tokens that start in [@p from, @p stop)
+		/// @return Where the last token ends
+		char const* lex_chunk(std::string_view input, char const* from, char const* stop, Interners& interners, std::vector<Token>& tokens)
+		{
+			auto raw = RawLexer(input, from, stop);
+			// about a token every three bytes
+			tokens.reserve(size_t(stop - from) / 3u + 1u);
+			while (not raw.done())
+				classify(raw.next(), interners, [&](Token const& tok) { tokens.push_back(tok); });
+
+			// only the chunk at the end of the input ends the token sequence
+			if (stop != input.data() + input.size()) tokens.pop_back();
+			return raw.position();
+		}
+
+		/// @return The line end to end a chunk starting at @p from with, the first one at @p at or after it
+		/// that closes a non-empty line, or @p end
+		/// \note a run of blank lines is taken by one newline token, a chunk ending inside it would be lexed again
+		char const* split_point(char const* from, char const* at, char const* end) noexcept
+		{
+			while ((at = scan::find_byte(at, end, '\n')) != end)
+			{
+				auto const line_end = at[-1] == '\r' ? at - 1 : at;
+				if (line_end > from and line_end[-1] != '\n' and line_end[-1] != '\r') return line_end;
+				++at;
+			}
+			return end;
+		}
+	}
+
+	batch_generator lex_parallel(std::string_view input, OperatorTable& operators, Interners& interners, size_t chunk_size, size_t batch_size) noexcept
+	{
+		auto const begin = input.data(), end = input.data() + input.size();
+		chunk_size = std::max(chunk_size, 1uz);
+		batch_size = std::max(batch_size, 1uz);
+
+		auto chunks = std::vector<chunk>();
+		for (auto from = begin; chunks.empty() or from != end;)
+		{
+			auto const stop = split_point(from, from + std::min(chunk_size, size_t(end - from)), end);
+			chunks.push_back({.from = from, .stop = stop});
+			from = stop;
+		}
+
+		// A text of one chunk has nothing to lex in parallel
+		if (chunks.size() == 1u)
+		{
+			co_yield elements_of(lex_batched(input, operators, interners, batch_size));
+			co_return;
+		}
+
+		auto const threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), chunks.size());
+		// The chunks lexed ahead of the one taken, bounding the memory their tokens take
+		auto const ahead = 2u * threads;
+		auto pool = boost::asio::thread_pool(threads);
+		auto posted = 0uz;
+
+		auto stages = FusedStages(operators);
+		auto reached = begin;
+		for (auto index = 0uz; index != chunks.size(); ++index)
+		{
+			for (; posted != chunks.size() and posted <= index + ahead; ++posted)
+			{
+				auto& part = chunks[posted];
+				auto task = std::packaged_task<void()>([&part, &interners, input] { part.reached = lex_chunk(input, part.from, part.stop, interners, part.tokens); });
+				part.lexed = task.get_future();
+				boost::asio::post(pool, std::move(task));
+			}
+
+			auto& part = chunks[index];
+			part.lexed.get();
+
+			// A token of the chunks before runs into this one: it is lexed again from the end of that token.
+			// The chunk at the end of the input is always lexed, it ends the token sequence
+			if (part.from != reached)
+			{
+				part.tokens.clear();
+				if (reached >= part.stop and index + 1u != chunks.size()) continue;
+				part.reached = lex_chunk(input, reached, part.stop, interners, part.tokens);
+			}
+			reached = part.reached;
+
+			// The indents, the operators and the neighbour tokens are followed in the order of the text
+			for (auto const& tok : part.tokens)
+			{
+				stages.push(tok);
+				if (stages.output_size() < batch_size) continue;
+
+				co_yield stages.output();
+				stages.clear_output();
+			}
+			part.tokens = {};
+		}
+
+		stages.flush();
+		if (stages.output_size() != 0u) co_yield stages.output();
+	}
+
+	batch_generator lex_parallel(std::string_view input, size_t chunk_size, size_t batch_size) noexcept
+	{
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		co_yield elements_of(lex_parallel(input, operators, interners, chunk_size, batch_size));
+	}
+}
@@ -0,0 +1,40 @@
+#include <thread>
+#include "../lexer.hpp"
+#include "token_ring.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		/// Closes the reading side of a ring when the consumer goes, done or not
+		struct reader_guard
+		{
+			TokenRing& ring;
+			~reader_guard() { ring.close_read(); }
+		};
+	}
+
+	batch_generator lex_pipelined(std::string_view input, OperatorTable& operators, Interners& interners, size_t ring_blocks, size_t batch_size) noexcept
+	{
+		auto ring = TokenRing(ring_blocks, batch_size);
+		auto producer = std::jthread([&]
+		{
+			for (auto const& batch : lex_batched(input, operators, interners, batch_size))
+			{
+				auto const block = ring.acquire_write();
+				if (block == nullptr) return;
+				block->assign(batch.begin(), batch.end());
+				ring.publish();
+			}
+			ring.close_write();
+		});
+		// destroyed before the producer is joined, which it lets go if it waits for a free block
+		auto const reading = reader_guard{ring};
+
+		while (auto const block = ring.acquire_read())
+		{
+			co_yield token_batch(*block);
+			ring.release();
+		}
+	}
+}
@@ -1,49 +1,87 @@
-﻿#include <locale>
+﻿#include <algorithm>
+#include <bit>
 #include <optional>
+#include <utility>
 #include "../lexer.hpp"
+#include "char_class.hpp"
+#include "stages.hpp"
+#include "scan.hpp"
 
 
 namespace ru::lexer::lex_raw
 {
-	static std::pair<char32_t, size_t> to_utf32(char const* begin, char const* end)
+	/// @return The code point of the sequence at @p begin and its length in bytes.
+	/// On @p validated input it is decoded with no checks; otherwise an ill-formed sequence is 0xFFFFFFFF of length 1,
+	/// a code point of no class
+	template <bool validated>
+	static std::pair<char32_t, size_t> to_utf32(char const* begin, char const* end) noexcept
 	{
-		auto original_begin = begin;
-		auto result = boost::locale::utf::utf_traits<char>::decode(begin, end);
-
-		if (result == boost::locale::utf::illegal || result == boost::locale::utf::incomplete)
-			throw boost::locale::conv::conversion_error();
-
-		return {(char32_t)result, begin - original_begin};
+		if constexpr (validated)
+		{
+			auto const length = size_t(std::countl_one((unsigned char)*begin));
+			auto ch = char32_t((unsigned char)*begin & (0x7Fu >> length));
+			for (auto i = 1uz; i < length; ++i)
+				ch = ch << 6 | char32_t(begin[i] & 0x3F);
+			return {ch, length};
+		}
+		else
+		{
+			auto const original_begin = begin;
+			auto const result = boost::locale::utf::utf_traits<char>::decode(begin, end);
+			if (result == boost::locale::utf::illegal or result == boost::locale::utf::incomplete) return {char32_t(-1), 1u};
+			return {(char32_t)result, size_t(begin - original_begin)};
+		}
 	}
 
-	static bool ctype_is(std::ctype_base::mask m, char const* begin, char const* end, size_t* len = nullptr)
+	using Ru::lexer::chars::char_class;
+
+	template <bool validated>
+	static bool ctype_is(char_class m, char const* begin, char const* end, size_t* len = nullptr) noexcept
 	{
 		if (begin == end) return false;
 		if ((signed char)*begin >= 0)
 		{
 			if (len != nullptr) *len = 1u;
-			if (*begin == '_' and m & std::ctype_base::lower)
-				return true;
-			switch (*begin)
-			{
-				case '_': case '"': case '\'': case ',': case ';': case '#': case '(': case ')':
-					m &= ~std::ctype_base::punct;
-				default:
-			}
-			return std::use_facet<std::ctype<char>>(std::locale()).is(m, *begin);
+			return has(Ru::lexer::chars::ascii[*begin], m);
 		}
-		auto [ch, _len] = to_utf32(begin, end);
+		auto [ch, _len] = to_utf32<validated>(begin, end);
 		if (len != nullptr) *len = _len;
-		return std::use_facet<std::ctype<char32_t>>(std::locale()).is(m, ch);
+		return has(Ru::lexer::chars::classify(ch), m);
 	}
 
-	static const char* ctype_scan_not(std::ctype_base::mask m, char const* begin, char const* end)
+	template <bool validated>
+	static const char* ctype_scan_not(char_class m, char const* begin, char const* end) noexcept
 	{
 		size_t len;
-		while (ctype_is(m, begin, end, &len)) begin += len;
+		while (ctype_is<validated>(m, begin, end, &len)) begin += len;
 		return begin;
 	}
 
+	/// \c ctype_scan_not(cont) with the ASCII runs skipped by vectors
+	template <bool validated>
+	static const char* scan_name(char const* begin, char const* end) noexcept
+	{
+		size_t len;
+		for (;;)
+		{
+			begin = Ru::lexer::scan::skip_ascii_word(begin, end);
+			if (begin != end and (signed char)*begin < 0 and ctype_is<validated>(char_class::cont, begin, end, &len)) begin += len;
+			else return begin;
+		}
+	}
+
+	/// @return The start of the first run of at least @p length @p quote bytes in [begin, end), or @p end
+	static const char* find_quotes(char const* begin, char const* end, char quote, size_t length) noexcept
+	{
+		while ((begin = Ru::lexer::scan::find_byte(begin, end, quote)) != end)
+		{
+			auto const run_end = Ru::lexer::scan::skip_byte(begin, end, quote);
+			if (size_t(run_end - begin) >= length) return begin;
+			begin = run_end;
+		}
+		return end;
+	}
+
 	using Ru::lexer::id;
 	using Ru::lexer::prec;
 	using Ru::lexer::none;
@@ -52,69 +90,57 @@ namespace ru::lexer::lex_raw
 	template <id id, prec prec, char ch>
 	static Ru::lexer::Token rule_symb(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
-		) noexcept
+		char const* const end
+	) noexcept
 	{
 		if (begin != end); else return none;
 		if (*begin == ch); else return none;
 		++begin;
-		return { .id = id, .prec = prec, .as_text = {begin - 1, begin}, .line = line, .column = begin - 1 - line_start };
+		return { .id = id, .prec = prec, .as_text = {begin - 1, begin} };
 	}
 
 
 	static Ru::lexer::Token rule_comment(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin + 1 < end); else return none;
 		if (begin[0] == '#' and begin[1] == '#'); else return none;
 
-		while (begin != end and *begin != '\n' and *begin != '\r') ++begin;
+		begin = Ru::lexer::scan::find_line_end(begin, end);
 		return skip;
 	}
 
 	static void subrule_skip_endl(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
-		bool moved = false;
-		if (begin != end and *begin == '\r') { ++begin; moved = true; }
-		if (begin != end and *begin == '\n') { ++begin; moved = true; }
-		if (moved) {++line; line_start = begin;}
+		if (begin != end and *begin == '\r') ++begin;
+		if (begin != end and *begin == '\n') ++begin;
 	}
 
 	static Ru::lexer::Token subrule_indent(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		auto const token_begin = begin;
-		while (begin != end and *begin == ' ') ++begin;
-		return { .id = id::newline, .prec = prec::semicolon, .as_text {token_begin, begin}, .line = line, .column = token_begin - line_start};
+		begin = Ru::lexer::scan::skip_byte(begin, end, ' ');
+		return { .id = id::newline, .prec = prec::semicolon, .as_text {token_begin, begin}};
 	}
 
 	static Ru::lexer::Token subrule_newline(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		for (;;)
 		{
-			subrule_skip_endl(begin, end, line, line_start);
-			auto token = subrule_indent(begin, end, line, line_start);
-			rule_comment(begin, end, line, line_start);
+			subrule_skip_endl(begin, end);
+			auto token = subrule_indent(begin, end);
+			rule_comment(begin, end);
 			if (begin != end); else return none;
 			if (*begin == '\r' or *begin == '\n'); else return token;
 		}
@@ -122,29 +148,24 @@ namespace ru::lexer::lex_raw
 
 	static Ru::lexer::Token rule_newline(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin != end); else return none;
 		if (*begin == '\r' or *begin == '\n'); else return none;
 
-		return subrule_newline(begin, end, line, line_start);
+		auto token = subrule_newline(begin, end);
+		return token ? token : skip; // trailing line ends are consumed with no token
 	}
 
 	Ru::lexer::Token rule_number(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept;
 
 	static Ru::lexer::Token rule_string(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin != end); else return none;
@@ -152,66 +173,56 @@ namespace ru::lexer::lex_raw
 		
 		auto const token_begin = begin;
 
-		while ( begin != end and *begin == '"') ++begin;
+		begin = Ru::lexer::scan::skip_byte(begin, end, '"');
 		auto const quo_open = std::string_view(token_begin, begin);
 		auto const length = quo_open.length();
 
-		if (length != 2u); else return {.id = id::string, .as_text = quo_open, .line = line, .column = token_begin - line_start};
-
-		auto const is_not_end = [&begin, length, quo_open]
-		{ 
-			return std::string_view(begin - length, begin) != quo_open;
-		};
-
-		auto const fst_line_start = line_start;
+		if (length != 2u); else return {.id = id::string, .as_text = quo_open};
 
-		++begin;
-		while (begin != end and is_not_end()) { ++begin; subrule_skip_endl(begin, end, line, line_start); }
+		// the opening run is maximal, so the body can't start with a quote
+		auto const closing = find_quotes(begin, end, '"', length);
+		begin = closing == end ? end : closing + length;
 
 		return {
-			.id = is_not_end() ? id::error_unclosed_string : id::string,
+			.id = closing == end ? id::error_unclosed_string : id::string,
 			.as_text {token_begin, begin},
-			.line = line,
-			.column = token_begin - fst_line_start
 		};
 	}
 
+	template <bool validated>
 	static Ru::lexer::Token rule_name(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin != end); else return none;
 
-		if (ctype_is(std::ctype_base::alpha, begin, end)); else return none;
+		if (ctype_is<validated>(char_class::start, begin, end)); else return none;
 
 		auto const token_begin = begin;
-		begin = ctype_scan_not(std::ctype_base::alnum, begin, end);
+		begin = scan_name<validated>(begin, end);
 
-		return {.id = id::identifier, .as_text {token_begin, begin}, .line = line, .column = token_begin - line_start};
+		return {.id = id::identifier, .as_text {token_begin, begin}};
 	}
 
+	template <bool validated>
 	static Ru::lexer::Token subrule_char(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
-		if (begin != end); else return { .id = id::error_standalone_quo, .as_text {begin - 1, begin}, .line = line, .column = begin - 1 - line_start };
+		if (begin != end); else return { .id = id::error_standalone_quo, .as_text {begin - 1, begin} };
 
 		if (*begin == '\\')
 		{
 			auto const token_begin = begin;
 			++begin;
 
-			if (begin != end); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin}, .line = line, .column = token_begin - 1 - line_start };
+			if (begin != end); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin} };
 
 			++begin;
 
-			if (begin != end); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin}, .line = line, .column = token_begin - 1 - line_start };
+			if (begin != end); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin} };
 
 			switch (begin[-1])
 			{
@@ -219,36 +230,33 @@ namespace ru::lexer::lex_raw
 				case 'X':
 				case 'u':
 				case 'U':
-					begin = ctype_scan_not(std::ctype_base::xdigit, begin, end);
+					begin = ctype_scan_not<validated>(char_class::xdigit, begin, end);
 				default:
 			}
 
-			if (begin != end and *begin == '\''); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin}, .line = line, .column = token_begin - 1 - line_start};
+			if (begin != end and *begin == '\''); else return { .id = id::error_unclosed_string, .as_text {token_begin - 1, begin}};
 			
 			++begin;
-			return { .id = id::character, .as_text {token_begin, begin - 1}, .line = line, .column = token_begin - line_start };
+			return { .id = id::character, .as_text {token_begin, begin - 1} };
 		}
 		else if (begin + 1 != end and begin[1] == '\'') { begin += 2; return {
 			.id = id::character,
 			.as_text {begin - 2, begin - 1},
-			.line = line,
-			.column = begin - 2 - line_start
 		}; }
 		else
 		{
 			auto const token_begin = begin;
-			begin = ctype_scan_not(std::ctype_base::graph, begin, end);
+			begin = ctype_scan_not<validated>(char_class::graph, begin, end);
 			if (begin != token_begin)
-				return { .id = id::op_expl, .as_text {token_begin, begin}, .line = line, .column = token_begin - line_start };
-			else return { .id = id::error_standalone_quo, .as_text {begin - 1, begin}, .line = line, .column = begin - 1 - line_start};
+				return { .id = id::op_expl, .as_text {token_begin, begin} };
+			else return { .id = id::error_standalone_quo, .as_text {begin - 1, begin}};
 		}
 	}
 
+	template <bool validated>
 	static Ru::lexer::Token rule_char(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin != end); else return none;
@@ -256,100 +264,251 @@ namespace ru::lexer::lex_raw
 
 		auto const token_begin = begin;
 
-		for (; begin != end and *begin == '\''; ++begin);
-		auto const quo_open = std::string_view(token_begin, begin);
-		auto const length = quo_open.length();
-
-		if (length != 1u); else return subrule_char(begin, end, line, line_start);
-		if (length != 3u); else return { .id = id::character, .as_text {token_begin + 1, token_begin + 2}, .line = line, .column = token_begin + 1 - line_start};
+		begin = Ru::lexer::scan::skip_byte(begin, end, '\'');
+		auto const length = size_t(begin - token_begin);
 
-		auto const is_not_end = [&begin, length, quo_open]
-		{
-			return
-				std::string_view(begin - length, begin) != quo_open
-				//or *begin == '\''
-				;
-		};
+		if (length != 1u); else return subrule_char<validated>(begin, end);
+		if (length != 3u); else return { .id = id::character, .as_text {token_begin + 1, token_begin + 2}};
 
-		++begin;
-		while (begin != end and *begin != '\r' and *begin != '\n' and is_not_end()) ++begin;
+		// explicit names don't span lines
+		auto const line_end = Ru::lexer::scan::find_line_end(begin, end);
+		auto const closing = find_quotes(begin, line_end, '\'', length);
+		begin = closing == line_end ? line_end : closing + length;
 
 		return {
-			.id = is_not_end() ? id::error_name_unclosed_string : id::id_expl,
-			.as_text = {token_begin + length, begin - length},
-			.line = line,
-			.column = token_begin + length - line_start,
+			.id = closing == line_end ? id::error_name_unclosed_string : id::id_expl,
+			.as_text = {token_begin + length, closing},
 			.shift = (int64_t)length,
 		};
 	}
 
+	template <bool validated>
 	static Ru::lexer::Token rule_operator(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
 		if (begin != end); else return none;
-		if (ctype_is(std::ctype_base::punct, begin, end)); else return none;
+		if (ctype_is<validated>(char_class::punct, begin, end)); else return none;
 
 		auto const token_begin = begin;
 
-		begin = ctype_scan_not(std::ctype_base::punct, begin, end);
-		return { .id = id::operator_, .as_text {token_begin, begin}, .line = line, .column = token_begin - line_start};
+		begin = ctype_scan_not<validated>(char_class::punct, begin, end);
+		return { .id = id::operator_, .as_text {token_begin, begin}};
 	}
+
+	/// An ill-formed UTF-8 sequence is one token with the continuation bytes after it
+	template <bool validated>
 	static Ru::lexer::Token rule_error(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
-		++begin;
-		return {.id = id::error, .as_text {begin - 1, begin}, .line = line, .column = begin - 1 - line_start};
+		auto const token_begin = begin++;
+		if constexpr (not validated)
+			if ((signed char)*token_begin < 0 and to_utf32<false>(token_begin, end).first == char32_t(-1))
+			{
+				while (begin != end and begin - token_begin < 4 and (*begin & 0xC0) == 0x80) ++begin;
+				return {.id = id::error_bad_utf8, .as_text {token_begin, begin}};
+			}
+		return {.id = id::error, .as_text {token_begin, begin}};
+	}
+
+	using rule_type = Ru::lexer::Token (*)(
+		char const*& __restrict begin,
+		char const* const end
+	) noexcept;
+
+	constexpr bool is_ascii_digit(unsigned char ch) noexcept
+	{
+		return ch >= '0' and ch <= '9';
 	}
 
+	/// Whether a byte is an ASCII character of the classes, or starts a non-ASCII one that may be
+	constexpr bool may_be(char_class m, unsigned char ch) noexcept
+	{
+		return ch >= Ru::lexer::chars::ascii.size() or has(Ru::lexer::chars::ascii[ch], m);
+	}
+
+	/// A rule paired with a predicate on the first byte of the tokens it may accept
+	/// \note bytes above ASCII start UTF-8 sequences and are left to the rules that decode them
+	struct rule_entry
+	{
+		rule_type rule;
+		bool (*accepts)(unsigned char first) noexcept;
+	};
+
+	template <char ch>
+	constexpr bool is_byte(unsigned char first) noexcept
+	{
+		return first == (unsigned char)ch;
+	}
+
+	/// The rules in priority order, decoding with no checks on @p validated input
+	template <bool validated>
 	constexpr auto rules = std::array
 	{
-		&rule_symb<id::skip, prec::other, ' '>,
-		&rule_symb<id::br_open, prec::open, '('>,
-		&rule_symb<id::br_close, prec::close, ')'>,
-		&rule_symb<id::comma, prec::comma, ','>,
-		&rule_symb<id::semicolon, prec::semicolon, ';'>,
-		&rule_symb<id::sharp, prec::other, '#'>,
-
-		&rule_comment,
-		&rule_newline,
-		&rule_number,
-		&rule_string,
-		&rule_name,
-		&rule_char,
-		&rule_operator,
-		&rule_error,
+		rule_entry{&rule_symb<id::skip, prec::other, ' '>, &is_byte<' '>},
+		rule_entry{&rule_symb<id::br_open, prec::open, '('>, &is_byte<'('>},
+		rule_entry{&rule_symb<id::br_close, prec::close, ')'>, &is_byte<')'>},
+		rule_entry{&rule_symb<id::comma, prec::comma, ','>, &is_byte<','>},
+		rule_entry{&rule_symb<id::semicolon, prec::semicolon, ';'>, &is_byte<';'>},
+		rule_entry{&rule_symb<id::sharp, prec::other, '#'>, &is_byte<'#'>},
+
+		rule_entry{&rule_comment, &is_byte<'#'>},
+		rule_entry{&rule_newline, [](unsigned char ch) noexcept { return ch == '\r' or ch == '\n'; }},
+		rule_entry{&rule_number, [](unsigned char ch) noexcept { return is_ascii_digit(ch) or ch == '.'; }},
+		rule_entry{&rule_string, &is_byte<'"'>},
+		rule_entry{&rule_name<validated>, [](unsigned char ch) noexcept { return may_be(char_class::start, ch); }},
+		rule_entry{&rule_char<validated>, &is_byte<'\''>},
+		rule_entry{&rule_operator<validated>, [](unsigned char ch) noexcept { return may_be(char_class::punct, ch); }},
+		rule_entry{&rule_error<validated>, [](unsigned char) noexcept { return true; }},
 	};
+
+	/// The most rules a single first byte may lead to, \c rule_error included
+	constexpr size_t max_candidates = 4u;
+
+	/// For each first byte, the rules that may accept a token starting with it, in priority order.
+	/// Every list ends with \c rule_error, so walking one always produces a token
+	template <bool validated>
+	constexpr auto dispatch = []
+	{
+		std::array<std::array<rule_type, max_candidates>, 256> table{};
+		for (unsigned ch = 0; ch != table.size(); ++ch)
+		{
+			auto candidate = table[ch].begin();
+			for (auto const& [rule, accepts] : rules<validated>)
+				if (accepts((unsigned char)ch)) *candidate++ = rule;
+		}
+		return table;
+	}();
+
+	static_assert(std::ranges::all_of(dispatch<true>, [](auto const& candidates) { return std::ranges::find(candidates, &rule_error<true>) != candidates.end(); }));
+	static_assert(std::ranges::all_of(dispatch<false>, [](auto const& candidates) { return std::ranges::find(candidates, &rule_error<false>) != candidates.end(); }));
+
+	/// @return The token at @p begin, a \c skip included
+	template <bool validated>
+	static Ru::lexer::Token step(
+		char const*& __restrict begin,
+		char const* const end
+	) noexcept
+	{
+		for (auto const rule : dispatch<validated>[(unsigned char)*begin])
+			if (auto result = rule(begin, end)) return result;
+		std::unreachable();
+	}
+
+	/// An ill-formed sequence up to @p end: its first byte and the continuation bytes after it
+	static Ru::lexer::Token subrule_bad_utf8(
+		char const*& __restrict begin,
+		char const* const end
+	) noexcept
+	{
+		auto const token_begin = begin++;
+		while (begin != end and begin - token_begin < 4 and (*begin & 0xC0) == 0x80) ++begin;
+		return {.id = id::error_bad_utf8, .as_text {token_begin, begin}};
+	}
+
+	/// About how much text is checked to be UTF-8 at once, up to a line end
+	constexpr size_t check_size = 16u * 1024u;
 }
 
 namespace Ru::lexer
 {
+	RawLexer::RawLexer(std::string_view input) noexcept
+		: RawLexer(input, input.data(), input.data() + input.length())
+	{}
+
+	RawLexer::RawLexer(std::string_view input, char const* from, char const* stop) noexcept
+		: begin(from)
+		, stop(stop)
+		, end(input.data() + input.length())
+		, checked(from)
+		, invalid(from)
+		, stage(from == input.data() ? stage::prologue : stage::body)
+	{}
+
+	// names, numbers and operators end at line ends, so a token starting in the checked text decodes nothing after it
+	void RawLexer::check() noexcept
+	{
+		auto const window_end = scan::find_line_end(begin + std::min(ru::lexer::lex_raw::check_size, size_t(stop - begin)), stop);
+		invalid = scan::validate_utf8(begin, window_end);
+		checked = window_end;
+	}
 
-	token_generator lex_raw(std::string_view input) noexcept
+	Token RawLexer::cut(Token const& token, char const* token_begin, char const* bad) noexcept
 	{
-		using namespace ru::lexer::lex_raw;
+		pending = {.id = id::error_bad_utf8, .as_text {bad, begin}};
+		// a comment is no token, a newline ends before the comments after it
+		if (token.id == id::skip or token.id == id::newline) return token;
+		return {
+			.id = token.id == id::string or token.id == id::error_unclosed_string ? id::error_unclosed_string : id::error,
+			.as_text {token_begin, bad},
+		};
+	}
 
-		auto begin = input.data();
-		auto const end = begin + input.length();
-		auto line = 0z;
-		auto line_begin = begin;
+	Token RawLexer::next() noexcept
+	{
+		using namespace ru::lexer::lex_raw;
 
-		co_yield subrule_newline(begin, end, line, line_begin);
+		switch (stage)
+		{
+			case stage::prologue:
+				stage = stage::body;
+				return subrule_newline(begin, end);
 
-		while (begin < end)
-			for (auto const rule : rules)
-				if (auto result = rule(begin, end, line, line_begin))
+			case stage::body:
+				for (;;)
 				{
-					if (result.id != id::skip) co_yield result;
-					break;
+					if (pending) return std::exchange(pending, none);
+					if (begin >= stop) break;
+					if (begin >= checked) check();
+
+					auto const token_begin = begin;
+					auto result = none;
+					if (begin == invalid)
+					{
+						result = subrule_bad_utf8(begin, checked);
+						invalid = scan::validate_utf8(begin, checked);
+					}
+					else if (result = step<true>(begin, invalid == checked ? end : invalid); begin == invalid and invalid != checked)
+					{
+						// the token is cut at the ill-formed sequence; when it goes on past it, the error takes the rest
+						auto whole = token_begin;
+						step<false>(whole, end);
+						if (whole > invalid)
+						{
+							begin = whole;
+							result = cut(result, token_begin, invalid);
+							invalid = begin < checked ? scan::validate_utf8(begin, checked) : begin;
+						}
+					}
+
+					// a string or a comment may run past the checked text
+					if (begin > checked)
+					{
+						if (auto const bad = scan::validate_utf8(checked, begin); bad != begin and not pending)
+							result = cut(result, token_begin, bad);
+						checked = invalid = begin;
+					}
+
+					if (result.id != id::skip) return result;
 				}
-		co_yield subrule_newline(begin, end, line, line_begin);
+				stage = stage::done;
+				// the rest of the input is another lexer's
+				if (begin < end) return none;
+				return subrule_newline(begin, end);
+
+			case stage::done:
+				return none;
+		}
+		std::unreachable();
 	}
-}
\ No newline at end of file
+
+	token_generator lex_raw(std::string_view input) noexcept
+	{
+		auto raw = RawLexer(input);
+		while (not raw.done())
+			co_yield raw.next();
+	}
+}
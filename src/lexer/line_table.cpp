@@ -0,0 +1,43 @@
+#include <algorithm>
+#include "line_table.hpp"
+#include "scan.hpp"
+
+namespace Ru::lexer
+{
+	LineTable::LineTable(std::string_view text)
+		: text(text)
+		, line_starts{0u}
+	{
+		auto const begin = text.data(), end = text.data() + text.size();
+		for (auto at = scan::find_line_end(begin, end); at != end; at = scan::find_line_end(at, end))
+		{
+			if (*at++ == '\r' and at != end and *at == '\n') ++at;
+			line_starts.push_back(uint32_t(at - begin));
+		}
+	}
+
+	position LineTable::resolve(char const* at) const noexcept
+	{
+		auto const offset = uint32_t(at - text.data());
+		auto const line = std::ranges::upper_bound(line_starts, offset) - line_starts.begin() - 1;
+		auto const line_begin = text.data() + line_starts[line];
+		return {.line = line, .column = intptr_t(scan::count_code_points(line_begin, at))};
+	}
+
+	occurance::position_in_text LineTable::locate(std::string_view piece) const noexcept
+	{
+		auto const begin = resolve(piece.data()), end = resolve(piece.data() + piece.size());
+		auto result = occurance::position_in_text();
+		result.line = size_t(begin.line);
+		result.line_end = size_t(end.line);
+		result.pos = size_t(begin.column);
+		result.pos_end = size_t(end.column);
+		return result;
+	}
+
+	std::string_view LineTable::line(size_t index) const noexcept
+	{
+		auto const begin = text.data() + line_starts[index];
+		return {begin, scan::find_line_end(begin, text.data() + text.size())};
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "../occurance.hpp"
+
+namespace Ru::lexer
+{
+	/// @brief A place in a text, both numbers from 0
+	struct position
+	{
+		intptr_t line;
+		/// The number of UTF-8 code points before the place on its line
+		intptr_t column;
+
+		friend bool operator==(position, position) noexcept = default;
+	};
+
+	/// The line starts of a text, found once by a vectorized scan.
+	/// Tokens only point into the text, their lines and columns are resolved here when needed.
+	/// '\\r\\n', '\\r' and '\\n' end a line each
+	class LineTable
+	{
+	public:
+		explicit LineTable(std::string_view text);
+
+		/// @return The place of a byte of the text, the end of the text included
+		position resolve(char const* at) const noexcept;
+		/// @return The place of a byte of the text by its offset
+		position resolve(size_t offset) const noexcept { return resolve(text.data() + offset); }
+
+		/// @return The place of a piece of the text, as diagnostics show it
+		occurance::position_in_text locate(std::string_view piece) const noexcept;
+
+		size_t line_count() const noexcept { return line_starts.size(); }
+
+		/// @return A line of the text, without its line end
+		std::string_view line(size_t index) const noexcept;
+
+	private:
+		std::string_view text;
+		/// The offset of the first byte of every line, the first one is 0
+		std::vector<uint32_t> line_starts;
+	};
+}
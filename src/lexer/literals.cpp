@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <charconv>
+#include <iterator>
+#include "literals.hpp"
+#include "scan.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		constexpr bool is_hex_digit(char ch) noexcept
+		{
+			return ch >= '0' and ch <= '9' or ch >= 'a' and ch <= 'f' or ch >= 'A' and ch <= 'F';
+		}
+
+		void append_code_point(std::string& out, uint32_t code_point)
+		{
+			if (not boost::locale::utf::is_valid_codepoint(code_point)) code_point = 0xFFFDu;
+			boost::locale::utf::utf_traits<char>::encode(code_point, std::back_inserter(out));
+		}
+	}
+
+	std::string_view literal_body(Token const& tok) noexcept
+	{
+		auto const text = tok.as_text;
+		if (tok.id != id::string) return text;
+
+		// the closing run of a string is as long as the opening one, "" is an empty string of a run of 1
+		auto const quotes = std::min(text.find_first_not_of('"'), text.size() / 2u);
+		return text.substr(quotes, text.size() - 2u * quotes);
+	}
+
+	void decode_escapes(std::string_view body, std::string& out)
+	{
+		out.clear();
+		auto at = body.begin();
+		for (;;)
+		{
+			auto const escape = std::find(at, body.end(), '\\');
+			out.append(at, escape);
+			if (escape == body.end()) return;
+
+			at = escape + 1;
+			if (at == body.end())
+			{
+				out += '\\';
+				return;
+			}
+
+			switch (auto const ch = *at++)
+			{
+				case 'n': out += '\n'; break;
+				case 'r': out += '\r'; break;
+				case 't': out += '\t'; break;
+				case '0': out += '\0'; break;
+				case 'a': out += '\a'; break;
+				case 'b': out += '\b'; break;
+				case 'e': out += '\x1B'; break;
+				case 'f': out += '\f'; break;
+				case 'v': out += '\v'; break;
+				case 'x':
+				case 'X':
+				case 'u':
+				case 'U':
+				{
+					auto const digits_end = std::find_if_not(at, body.end(), is_hex_digit);
+					if (digits_end == at)
+					{
+						out += ch;
+						break;
+					}
+
+					auto value = uint32_t(0);
+					if (std::from_chars(&*at, &*at + (digits_end - at), value, 16).ec != std::errc()) value = UINT32_MAX;
+					at = digits_end;
+
+					if ((ch == 'x' or ch == 'X') and value <= 0xFFu) out += char(value);
+					else append_code_point(out, value);
+					break;
+				}
+				default: out += ch;
+			}
+		}
+	}
+
+	Symbol intern_literal(std::string_view body, Interner& literals)
+	{
+		// most literals have no escapes and are their own value
+		if (scan::find_byte(body.data(), body.data() + body.size(), '\\') == body.data() + body.size())
+			return literals.intern(body);
+
+		thread_local auto decoded = std::string();
+		decode_escapes(body, decoded);
+		return literals.intern(decoded);
+	}
+}
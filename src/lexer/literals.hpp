@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "../lexer.hpp"
+#include "symbols.hpp"
+
+namespace Ru::lexer
+{
+	/// @return The text of a string or a character literal token without its quotes
+	std::string_view literal_body(Token const& tok) noexcept;
+
+	/// Decodes the escapes of a literal's body into @p out: \\n \\r \\t \\0 \\a \\b \\e \\f \\v,
+	/// \\x and \\u with hex digits, and a backslash before any other character for that character.
+	/// \\x of up to 0xFF is a byte, \\u and a larger \\x are UTF-8 encoded code points
+	void decode_escapes(std::string_view body, std::string& out);
+
+	/// @return The value of a literal's body in @p literals, decoded when it has escapes
+	Symbol intern_literal(std::string_view body, Interner& literals);
+
+	/// Decodes the limbs of a big integer token into @p limbs; \c lex_raw leaves them out, it has no store to keep them in
+	void keep_limbs(Token& tok, LimbStore& limbs);
+}
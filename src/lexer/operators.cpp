@@ -0,0 +1,58 @@
+#include <limits>
+#include "operators.hpp"
+#include "stages.hpp"
+
+namespace Ru::lexer
+{
+	static size_t hash(std::string_view spelling) noexcept
+	{
+		auto hash = 0x811C9DC5u;
+		for (auto const ch : spelling)
+			hash = (hash ^ (unsigned char)ch) * 0x01000193u;
+		return hash;
+	}
+
+	OperatorTable::OperatorTable()
+		: entries(1u)
+		, slots(64u)
+	{}
+
+	OperatorTable::index_type OperatorTable::intern(std::string_view spelling)
+	{
+		auto const mask = slots.size() - 1u;
+		auto slot = hash(spelling) & mask;
+		for (; slots[slot] != 0u; slot = (slot + 1u) & mask)
+		{
+			auto& found = entries[slots[slot]];
+			if (found.spelling != spelling) continue;
+
+			found.uses++;
+			return slots[slot];
+		}
+
+		if (entries.size() > std::numeric_limits<index_type>::max()) return 0u;
+
+		auto const index = index_type(entries.size());
+		entries.push_back({
+			.spelling = spellings.emplace_back(spelling),
+			.prec = get_precision(spelling),
+			.uses = 1u,
+		});
+		slots[slot] = index;
+
+		if (entries.size() * 2u > slots.size()) rehash(slots.size() * 2u);
+		return index;
+	}
+
+	void OperatorTable::rehash(size_t slot_count)
+	{
+		slots.assign(slot_count, 0u);
+		auto const mask = slot_count - 1u;
+		for (auto index = 1uz; index != entries.size(); ++index)
+		{
+			auto slot = hash(entries[index].spelling) & mask;
+			while (slots[slot] != 0u) slot = (slot + 1u) & mask;
+			slots[slot] = index_type(index);
+		}
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "../lexer.hpp"
+
+namespace Ru::lexer
+{
+	/// The distinct operator spellings of a module, each one classified once.
+	/// An operator token refers to its entry by \c Token::operator_index
+	class OperatorTable
+	{
+	public:
+		using index_type = uint16_t;
+
+		struct entry
+		{
+			std::string_view spelling;
+			prec prec = prec::intern;
+			/// How many times the module uses the operator
+			size_t uses = 0u;
+		};
+
+		OperatorTable();
+
+		/// Finds or adds an operator and counts the use of it
+		/// @return The index of the operator; 0 only when the table is full
+		index_type intern(std::string_view spelling);
+
+		/// Uncounts a use of an operator, as the token using it is gone
+		/// \note an operator used no more keeps its index
+		void release(index_type index) noexcept { entries[index].uses--; }
+
+		entry const& operator[](index_type index) const noexcept { return entries[index]; }
+
+		/// @return Every operator the module uses, in the order of their first uses
+		std::span<entry const> used() const noexcept { return std::span(entries).subspan(1u); }
+
+	private:
+		void rehash(size_t slot_count);
+
+		/// The entries, [0] is a placeholder for the tokens that are not operators
+		std::vector<entry> entries;
+		/// An open addressing index of the entries, 0 is an empty slot
+		std::vector<index_type> slots;
+		/// Owns the spellings, so the table outlives the text it was made of
+		std::deque<std::string> spellings;
+	};
+}
@@ -1,5 +1,6 @@
 #include <unordered_map>
 #include "../lexer.hpp"
+#include "stages.hpp"
 
 namespace Ru::lexer
 {
@@ -44,7 +45,7 @@ namespace Ru::lexer
 		return false;
 	}
 
-	static prec get_precision(std::string_view input)
+	prec get_precision(std::string_view input)
 	{
 		if (is_cmp(input)) return prec::cmp;
 
@@ -66,7 +67,7 @@ namespace Ru::lexer
 				max_bin_prec = std::max(max_bin_prec, prec::cmp);
 
 			auto found_un_it = symb_infixes.find(curr);
-			if (found_un_it != two_symb_infixes.end())
+			if (found_un_it != symb_infixes.end())
 			{
 				prec found_un = found_un_it->second;
 				max_un_prec = std::max(max_un_prec, found_un);
@@ -101,6 +102,7 @@ namespace Ru::lexer
 			{
 				Token copy = tok;
 				copy.prec = get_precision(tok.as_text);
+				co_yield copy;
 			}
 			else co_yield tok;
 		}
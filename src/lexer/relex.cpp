@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include "relex.hpp"
+#include "stages.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		/// A line end the lexing may start again at
+		struct restart
+		{
+			/// The line end, in the text
+			size_t at;
+			/// The first token after it
+			size_t index;
+		};
+
+		/// @return The last line end before @p before where the lexer starts a newline token or is inside one:
+		/// no token spans it, and no token starts at it as a character literal of it
+		std::optional<restart> find_restart(std::string_view text, TokenBuffer const& tokens, size_t origin, size_t before)
+		{
+			auto const offsets = tokens.offsets();
+			auto const lengths = tokens.lengths();
+
+			for (auto at = std::min(before, text.size()); at-- > origin;)
+			{
+				if (text[at] != '\r' and text[at] != '\n') continue;
+
+				auto const relative = uint32_t(at - origin);
+				auto const index = size_t(std::ranges::lower_bound(offsets, relative) - offsets.begin());
+				// the tokens before the line end make the lexer leave the prologue
+				if (index == 0u) return std::nullopt;
+				if (index == offsets.size()) continue;
+
+				if (offsets[index - 1u] + lengths[index - 1u] > relative or offsets[index] == relative) continue;
+				return restart{at, index};
+			}
+			return std::nullopt;
+		}
+
+		/// Opens and closes the indents the tokens [from, to) of a buffer do
+		void replay_indents(TokenBuffer const& tokens, size_t from, size_t to, std::vector<size_t>& indents)
+		{
+			auto const ids = tokens.ids();
+			auto const lengths = tokens.lengths();
+			for (auto i = from; i != to; ++i)
+			{
+				if (ids[i] == id::indent) indents.push_back(lengths[i]);
+				else if (ids[i] == id::dedent) indents.pop_back();
+			}
+		}
+
+		void release(TokenBuffer const& tokens, size_t from, size_t to, OperatorTable& operators)
+		{
+			for (auto const index : tokens.operator_indices().subspan(from, to - from))
+				if (index != 0u) operators.release(index);
+		}
+	}
+
+	TokenEdit relex(std::string& text, TokenBuffer& tokens, TextEdit const& edit, OperatorTable& operators, Interners& interners)
+	{
+		auto const old_size = tokens.size();
+		auto const origin = tokens.origin() == nullptr ? 0uz : size_t(tokens.origin() - text.data());
+		auto const start = tokens.origin() == nullptr ? std::nullopt : find_restart(text, tokens, origin, edit.offset);
+
+		text.replace(edit.offset, edit.removed, edit.inserted);
+		auto const shift = ptrdiff_t(edit.inserted.size()) - ptrdiff_t(edit.removed);
+
+		if (not start)
+		{
+			release(tokens, 0u, old_size, operators);
+			tokens = TokenBuffer(lex_batched(text, operators, interners));
+			return {0u, old_size, tokens.size()};
+		}
+
+		// The stages start from the state they had at the line end
+		auto indents = std::vector<size_t>{0uz};
+		replay_indents(tokens, 0u, start->index, indents);
+
+		auto last = tokens[start->index - 1u];
+		last.as_text = {text.data() + origin + tokens.offsets()[start->index - 1u], last.as_text.size()};
+
+		auto stages = FusedStages(operators);
+		stages.resume(indents, last);
+
+		auto const offsets = tokens.offsets();
+		auto const edit_end = edit.offset + edit.inserted.size();
+		auto raw = RawLexer(text, text.data() + start->at, text.data() + text.size());
+
+		// The old tokens are followed along, the ones of the line ends after the edit are compared with the new ones
+		auto old_index = start->index;
+		auto synced = old_size;
+		while (not raw.done())
+		{
+			auto const tok = raw.next();
+			classify(tok, interners, [&](Token const& classified) { stages.push(classified); });
+
+			if (tok.id != id::newline) continue;
+			auto const at = size_t(tok.as_text.data() - text.data());
+			if (at < edit_end) continue;
+
+			// The newline token is held back by the stages, the last token and the indents are before it
+			auto const old_at = uint32_t(ptrdiff_t(at) - shift - ptrdiff_t(origin));
+			auto const from = old_index;
+			while (old_index != old_size and offsets[old_index] < old_at) ++old_index;
+			replay_indents(tokens, from, old_index, indents);
+
+			if (old_index == old_size or offsets[old_index] != old_at) continue;
+
+			auto const old_id = tokens.ids()[old_index];
+			if (old_id != id::newline and old_id != id::indent and old_id != id::dedent) continue;
+			if (tokens.precs()[old_index - 1u] != stages.last_output().prec) continue;
+			if (not std::ranges::equal(indents, stages.open_indents())) continue;
+
+			synced = old_index;
+			break;
+		}
+		if (synced == old_size) stages.flush();
+
+		release(tokens, start->index, synced, operators);
+		tokens.splice(start->index, synced, stages.output(), shift, text.data() + origin);
+		return {start->index, synced - start->index, stages.output_size()};
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include "operators.hpp"
+#include "symbols.hpp"
+#include "token_buffer.hpp"
+
+namespace Ru::lexer
+{
+	/// @brief A change of a text: @c removed bytes at @c offset replaced by @c inserted
+	struct TextEdit
+	{
+		size_t offset;
+		size_t removed;
+		/// Not a part of the edited text
+		std::string_view inserted;
+	};
+
+	/// @brief The change of a token buffer an edit of its text made: @c removed tokens at @c first replaced by @c inserted ones
+	struct TokenEdit
+	{
+		size_t first;
+		size_t removed;
+		size_t inserted;
+	};
+
+	/// Applies an edit to a text and brings its tokens up to date. The text is lexed again from
+	/// the last line end before the edit that no token spans, until a line after the edit starts
+	/// with the indents and the neighbour token it started with before; the tokens after it are moved
+	/// @param tokens The tokens of the whole text, as \c lex_batched gives them
+	/// @param operators The table the tokens were lexed with
+	/// @param interners The interners the tokens were lexed with
+	TokenEdit relex(std::string& text, TokenBuffer& tokens, TextEdit const& edit, OperatorTable& operators, Interners& interners);
+}
@@ -1,54 +1,228 @@
-#include <locale>
-#include <boost/spirit/include/qi.hpp>
+#include <charconv>
+#include <cmath>
+#include <limits>
+#include <string>
 #include "../lexer.hpp"
+#include "symbols.hpp"
 
-namespace Ru::lexer::lex_raw
+namespace ru::lexer::lex_raw
 {
-	Ru::lexer::Token subrule_number(
+	using Ru::lexer::Token;
+	using Ru::lexer::Number;
+	using Ru::lexer::id;
+	using Ru::lexer::none;
+
+	namespace
+	{
+		struct radix_t
+		{
+			unsigned base;
+			/// The exponent letter, lowercase
+			char exponent;
+		};
+
+		constexpr radix_t decimal{10u, 'e'}, hexadecimal{16u, 'p'}, binary{2u, 'p'};
+
+		/// @return The value of a digit, or 255 when it is not a digit
+		constexpr unsigned digit_value(unsigned char ch) noexcept
+		{
+			if (ch >= '0' and ch <= '9') return ch - '0';
+			if ((ch | 0x20u) >= 'a' and (ch | 0x20u) <= 'f') return (ch | 0x20u) - 'a' + 10u;
+			return 255u;
+		}
+
+		bool is_digit(char const ch, radix_t radix) noexcept
+		{
+			return digit_value(ch) < radix.base;
+		}
+
+		/// Scans digits separated by single quotes: +digit % '\''
+		/// @return The end of the digits, nullptr when there is no digit at @p begin
+		char const* scan_digits(char const* begin, char const* const end, radix_t radix) noexcept
+		{
+			if (begin == end or not is_digit(*begin, radix)) return nullptr;
+			for (++begin; begin != end; )
+			{
+				if (is_digit(*begin, radix)) ++begin;
+				else if (*begin == '\'' and end - begin > 1 and is_digit(begin[1], radix)) begin += 2;
+				else break;
+			}
+			return begin;
+		}
+
+		/// Scans a signed decimal exponent that fits 64 bits
+		/// @return The end of the exponent, nullptr when there is none
+		char const* scan_exponent(char const* begin, char const* const end, int64_t& value) noexcept
+		{
+			if (begin != end and *begin == '+' and end - begin > 1 and begin[1] != '-') ++begin;
+			auto const [ptr, error] = std::from_chars(begin, end, value);
+			if (error != std::errc{}) return nullptr;
+			return ptr;
+		}
+
+		/// Decodes the digits of an integer in 64 bits; one that does not fit is a big integer with no limbs yet
+		Number decode_integer(std::string_view digits, radix_t radix) noexcept
+		{
+			auto value = uint64_t(0);
+			auto it = digits.begin();
+			for (; it != digits.end(); ++it)
+			{
+				if (*it == '\'') continue;
+				if (__builtin_mul_overflow(value, radix.base, &value)
+				or __builtin_add_overflow(value, digit_value(*it), &value))
+					break;
+			}
+			if (it == digits.end()) return {.kind = Number::kind::integer, .integer = value};
+			return {.kind = Number::kind::big_integer};
+		}
+
+		/// Decodes the digits of an integer into as many limbs as needed
+		std::vector<uint64_t> decode_limbs(std::string_view digits, radix_t radix)
+		{
+			auto limbs = std::vector<uint64_t>{0u};
+			for (auto const ch : digits)
+			{
+				if (ch == '\'') continue;
+				auto carry = (unsigned __int128)digit_value(ch);
+				for (auto& limb : limbs)
+				{
+					auto const product = (unsigned __int128)limb * radix.base + carry;
+					limb = uint64_t(product);
+					carry = product >> 64u;
+				}
+				if (carry != 0u) limbs.push_back(uint64_t(carry));
+			}
+			return limbs;
+		}
+
+		/// Decodes a floating number, correctly rounded by std::from_chars.
+		/// Binary digits are regrouped into hexadecimal ones first
+		Number decode_floating(std::string_view whole, std::string_view fraction, int64_t exponent, radix_t radix)
+		{
+			auto text = std::string();
+			auto const append = [&](std::string_view digits)
+			{
+				for (auto const ch : digits)
+					if (ch != '\'') text += ch;
+			};
+
+			if (radix.base == 2u)
+			{
+				// Padded to whole nibbles on the side away from the point
+				auto const nibbles = [&](std::string_view digits, bool is_whole)
+				{
+					auto bits = std::string();
+					for (auto const ch : digits) if (ch != '\'') bits += ch;
+					bits.insert(is_whole ? 0u : bits.size(), (4u - bits.size() % 4u) % 4u, '0');
+					for (auto i = 0uz; i != bits.size(); i += 4u)
+						text += "0123456789abcdef"[(bits[i] - '0') << 3 | (bits[i + 1u] - '0') << 2 | (bits[i + 2u] - '0') << 1 | (bits[i + 3u] - '0')];
+				};
+				nibbles(whole.empty() ? "0" : whole, true);
+				text += '.';
+				nibbles(fraction, false);
+			}
+			else
+			{
+				append(whole.empty() ? "0" : whole);
+				text += '.';
+				append(fraction);
+			}
+			text += radix.base == 10u ? 'e' : 'p';
+			text += std::to_string(exponent);
+
+			auto const format = radix.base == 10u ? std::chars_format::general : std::chars_format::hex;
+			auto value = 0.0;
+			auto const [ptr, error] = std::from_chars(text.data(), text.data() + text.size(), value, format);
+			if (error == std::errc::result_out_of_range)
+			{
+				// The magnitude of the first non-zero digit tells an overflow from an underflow
+				auto const first = text.find_first_not_of("0.");
+				auto const point = text.find('.');
+				auto order = first < point ? intptr_t(point - first) : -intptr_t(first - point - 1u);
+				auto const step = radix.base == 10u ? 1 : 4;
+				value = order * step + exponent > 0 ? std::numeric_limits<double>::infinity() : 0.0;
+			}
+			return {.kind = Number::kind::floating, .floating = value};
+		}
+	}
+
+	/// Scans and decodes a number:
+	/// \code
+	/// number   := ('0x' | '0X') mantissa<xdigit> ([pP] exponent)?
+	///           | ('0b' | '0B') mantissa<bdigit> ([pP] exponent)?
+	///           |               mantissa<digit>  ([eE] exponent)?
+	/// mantissa := (digits? '.')? digits
+	/// digits   := digit+ % '\''
+	/// \endcode
+	/// A number with a fraction or an exponent is floating, an exponent is in \c shift
+	Ru::lexer::Token rule_number(
 		char const*& __restrict begin,
-		char const* const end,
-		intptr_t& __restrict line,
-		char const*& __restrict line_start
+		char const* const end
 	) noexcept
 	{
-		namespace qi = boost::spirit::qi;
-
 		char const* const orig_begin = begin;
 
-		Token result = {.id = id::number, .line = line, .column = begin - line_start};
-
-		auto hex_prefix = (qi::lit("0x") | "0X" )[([&] () {result.prefix = 2;})];
-		auto bin_prefix = (qi::lit("0b") | "0B" )[([&] () {result.prefix = 2;})];
-
-		auto digits = +qi::digit % '\'';
-		auto xdigits = +qi::xdigit % '\'';
-		auto bdigits = +(qi::lit('0') | '1') % '\'';
-
-		auto expr =
-			(
-				-(-digits >> '.') >> digits >> -(
-				    (qi::lit('e') | 'E')
-					>> qi::long_long[([&] (int64_t value) {result.shift = value;})]
-			    )
-			)
-			| (hex_prefix
-			   >> -(-xdigits >> '.') >> xdigits >> -(
-			   (qi::char_('p') | qi::char_('P'))
-			       >> qi::long_long[([&] (int64_t value) {result.shift = value;})]
-				)
-			)
-			| (bin_prefix
-			   >> -(-bdigits >> '.') >> bdigits >> -(
-			   (qi::char_('p') | qi::char_('P'))
-			       >> qi::long_long[([&] (int64_t value) {result.shift = value;})]
-				)
-			)
-			;
-
-		auto ok = qi::parse(begin, end, expr);
-		if (not ok or orig_begin == begin) return none;
-
-		result.as_text = std::string_view(orig_begin, begin);
+		Token result = {.id = id::number, .as_text = {}};
+
+		auto whole = std::string_view(), fraction = std::string_view();
+		auto is_floating = false;
+		auto const scan_mantissa = [&](char const* it, radix_t radix) noexcept -> char const*
+		{
+			if (auto const whole_end = scan_digits(it, end, radix))
+			{
+				whole = {it, whole_end};
+				it = whole_end;
+			}
+			if (it != end and *it == '.')
+				if (auto const fraction_end = scan_digits(it + 1, end, radix))
+				{
+					fraction = {it + 1, fraction_end};
+					it = fraction_end;
+					is_floating = true;
+				}
+			return whole.empty() and fraction.empty() ? nullptr : it;
+		};
+
+		auto radix = decimal;
+		auto it = static_cast<char const*>(nullptr);
+		if (end - begin > 2 and begin[0] == '0' and ((begin[1] | 0x20) == 'x' or (begin[1] | 0x20) == 'b'))
+		{
+			radix = (begin[1] | 0x20) == 'x' ? hexadecimal : binary;
+			it = scan_mantissa(begin + 2, radix);
+			if (it) result.prefix = 2;
+		}
+		if (not it)
+		{
+			radix = decimal;
+			it = scan_mantissa(begin, radix);
+		}
+		if (not it) return none;
+
+		if (it != end and (*it | 0x20) == radix.exponent)
+			if (auto const exponent_end = scan_exponent(it + 1, end, result.shift))
+			{
+				it = exponent_end;
+				is_floating = true;
+			}
+
+		result.as_text = std::string_view(orig_begin, it);
+		result.number = is_floating
+			? decode_floating(whole, fraction, result.shift, radix)
+			: decode_integer(whole, radix);
+		begin = it;
 		return result;
 	}
-}
\ No newline at end of file
+}
+
+namespace Ru::lexer
+{
+	void keep_limbs(Token& tok, LimbStore& limbs)
+	{
+		using namespace ru::lexer::lex_raw;
+
+		auto const radix = tok.prefix == 0 ? decimal : (tok.as_text[1] | 0x20) == 'x' ? hexadecimal : binary;
+		auto const kept = limbs.keep(decode_limbs(tok.as_text.substr(size_t(tok.prefix)), radix));
+		tok.number.size = uint32_t(kept.size());
+		tok.number.limbs = kept.data();
+	}
+}
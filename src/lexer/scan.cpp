@@ -0,0 +1,485 @@
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "scan.hpp"
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define RU_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace Ru::lexer::scan
+{
+	namespace
+	{
+		constexpr bool is_ascii_word(char ch) noexcept
+		{
+			return (ch >= 'a' and ch <= 'z') or (ch >= 'A' and ch <= 'Z') or (ch >= '0' and ch <= '9') or ch == '_';
+		}
+
+		namespace scalar_impl
+		{
+			char const* find_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				while (begin != end and *begin != ch) ++begin;
+				return begin;
+			}
+
+			char const* skip_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				while (begin != end and *begin == ch) ++begin;
+				return begin;
+			}
+
+			char const* find_line_end(char const* begin, char const* end) noexcept
+			{
+				while (begin != end and *begin != '\r' and *begin != '\n') ++begin;
+				return begin;
+			}
+
+			char const* skip_ascii_word(char const* begin, char const* end) noexcept
+			{
+				while (begin != end and is_ascii_word(*begin)) ++begin;
+				return begin;
+			}
+
+			size_t count_code_points(char const* begin, char const* end) noexcept
+			{
+				auto count = 0uz;
+				for (; begin != end; ++begin)
+					count += (signed char)*begin >= -64; // not 10xxxxxx
+				return count;
+			}
+
+			/// @return The end of the well-formed sequence of 2 to 4 bytes at @p begin, or @c nullptr
+			char const* sequence_end(char const* begin, char const* end) noexcept
+			{
+				// the lead byte narrows the second one, against the overlong forms, the surrogates and what is above U+10FFFF
+				auto const lead = (unsigned char)*begin;
+				auto low = 0x80u, high = 0xBFu;
+				auto length = 0z;
+				if (lead >= 0xC2u and lead <= 0xDFu) length = 2;
+				else if (lead >= 0xE0u and lead <= 0xEFu)
+				{
+					length = 3;
+					if (lead == 0xE0u) low = 0xA0u;
+					else if (lead == 0xEDu) high = 0x9Fu;
+				}
+				else if (lead >= 0xF0u and lead <= 0xF4u)
+				{
+					length = 4;
+					if (lead == 0xF0u) low = 0x90u;
+					else if (lead == 0xF4u) high = 0x8Fu;
+				}
+				else return nullptr;
+
+				if (end - begin >= length); else return nullptr;
+				if ((unsigned char)begin[1] >= low and (unsigned char)begin[1] <= high); else return nullptr;
+				for (auto i = 2z; i != length; ++i)
+					if ((begin[i] & 0xC0) != 0x80) return nullptr;
+				return begin + length;
+			}
+
+			char const* validate_utf8(char const* begin, char const* end) noexcept
+			{
+				while (begin != end)
+					if ((signed char)*begin >= 0) ++begin;
+					else if (auto const next = sequence_end(begin, end)) begin = next;
+					else return begin;
+				return end;
+			}
+		}
+
+#ifdef RU_SCAN_X86
+		/// Each vector kernel compares whole vectors to get a bitmask of the bytes to stop at,
+		/// and leaves the tail shorter than a vector to the narrower kernel
+		namespace sse2_impl
+		{
+			inline __m128i load(char const* at) noexcept
+			{
+				return _mm_loadu_si128(reinterpret_cast<__m128i const*>(at));
+			}
+
+			inline uint32_t movemask(__m128i bytes) noexcept
+			{
+				return (uint32_t)_mm_movemask_epi8(bytes);
+			}
+
+			/// Unsigned @c lo <= x <= @c hi for every byte
+			inline __m128i in_range(__m128i x, char lo, char hi) noexcept
+			{
+				return _mm_cmpeq_epi8(_mm_min_epu8(_mm_max_epu8(x, _mm_set1_epi8(lo)), _mm_set1_epi8(hi)), x);
+			}
+
+			inline uint32_t find_byte_mask(__m128i v, __m128i needle) noexcept
+			{
+				return movemask(_mm_cmpeq_epi8(v, needle));
+			}
+
+			inline uint32_t line_end_mask(__m128i v) noexcept
+			{
+				return movemask(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))));
+			}
+
+			/// The UTF-8 continuation bytes, 10xxxxxx, are the signed ones below -64
+			inline uint32_t continuation_mask(__m128i v) noexcept
+			{
+				return movemask(_mm_cmpgt_epi8(_mm_set1_epi8(-64), v));
+			}
+
+			inline uint32_t non_word_mask(__m128i v) noexcept
+			{
+				auto const alpha = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+				auto const digit = in_range(v, '0', '9');
+				auto const under = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+				return movemask(_mm_or_si128(_mm_or_si128(alpha, digit), under)) ^ 0xFFFFu;
+			}
+
+			char const* find_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				auto const needle = _mm_set1_epi8(ch);
+				for (; end - begin >= 16; begin += 16)
+					if (uint32_t const mask = find_byte_mask(load(begin), needle))
+						return begin + std::countr_zero(mask);
+				return scalar_impl::find_byte(begin, end, ch);
+			}
+
+			char const* skip_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				auto const needle = _mm_set1_epi8(ch);
+				for (; end - begin >= 16; begin += 16)
+					if (uint32_t const mask = find_byte_mask(load(begin), needle) ^ 0xFFFFu)
+						return begin + std::countr_zero(mask);
+				return scalar_impl::skip_byte(begin, end, ch);
+			}
+
+			char const* find_line_end(char const* begin, char const* end) noexcept
+			{
+				for (; end - begin >= 16; begin += 16)
+					if (uint32_t const mask = line_end_mask(load(begin)))
+						return begin + std::countr_zero(mask);
+				return scalar_impl::find_line_end(begin, end);
+			}
+
+			char const* skip_ascii_word(char const* begin, char const* end) noexcept
+			{
+				for (; end - begin >= 16; begin += 16)
+					if (uint32_t const mask = non_word_mask(load(begin)))
+						return begin + std::countr_zero(mask);
+				return scalar_impl::skip_ascii_word(begin, end);
+			}
+
+			size_t count_code_points(char const* begin, char const* end) noexcept
+			{
+				auto count = 0uz;
+				for (; end - begin >= 16; begin += 16)
+					count += 16u - std::popcount(continuation_mask(load(begin)));
+				return count + scalar_impl::count_code_points(begin, end);
+			}
+
+			/// Skips the ASCII by vectors and checks the sequences one by one, SSE2 has no byte shuffle for table lookups
+			char const* validate_utf8(char const* begin, char const* end) noexcept
+			{
+				for (;;)
+				{
+					for (; end - begin >= 16; begin += 16)
+						if (uint32_t const mask = movemask(load(begin)))
+						{
+							begin += std::countr_zero(mask);
+							break;
+						}
+					if (end - begin < 16) return scalar_impl::validate_utf8(begin, end);
+
+					while (begin != end and (signed char)*begin < 0)
+						if (auto const next = scalar_impl::sequence_end(begin, end)) begin = next;
+						else return begin;
+				}
+			}
+		}
+
+		namespace avx2_impl
+		{
+			#define RU_AVX2 [[gnu::target("avx2")]]
+
+			RU_AVX2 inline __m256i load(char const* at) noexcept
+			{
+				return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(at));
+			}
+
+			RU_AVX2 inline uint32_t movemask(__m256i bytes) noexcept
+			{
+				return (uint32_t)_mm256_movemask_epi8(bytes);
+			}
+
+			RU_AVX2 inline __m256i in_range(__m256i x, char lo, char hi) noexcept
+			{
+				return _mm256_cmpeq_epi8(_mm256_min_epu8(_mm256_max_epu8(x, _mm256_set1_epi8(lo)), _mm256_set1_epi8(hi)), x);
+			}
+
+			RU_AVX2 inline uint32_t find_byte_mask(__m256i v, __m256i needle) noexcept
+			{
+				return movemask(_mm256_cmpeq_epi8(v, needle));
+			}
+
+			RU_AVX2 inline uint32_t line_end_mask(__m256i v) noexcept
+			{
+				return movemask(_mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'))));
+			}
+
+			RU_AVX2 inline uint32_t continuation_mask(__m256i v) noexcept
+			{
+				return movemask(_mm256_cmpgt_epi8(_mm256_set1_epi8(-64), v));
+			}
+
+			RU_AVX2 inline uint32_t non_word_mask(__m256i v) noexcept
+			{
+				auto const alpha = in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+				auto const digit = in_range(v, '0', '9');
+				auto const under = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_'));
+				return ~movemask(_mm256_or_si256(_mm256_or_si256(alpha, digit), under));
+			}
+
+			RU_AVX2 char const* find_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				auto const needle = _mm256_set1_epi8(ch);
+				for (; end - begin >= 32; begin += 32)
+					if (uint32_t const mask = find_byte_mask(load(begin), needle))
+						return begin + std::countr_zero(mask);
+				return sse2_impl::find_byte(begin, end, ch);
+			}
+
+			RU_AVX2 char const* skip_byte(char const* begin, char const* end, char ch) noexcept
+			{
+				auto const needle = _mm256_set1_epi8(ch);
+				for (; end - begin >= 32; begin += 32)
+					if (uint32_t const mask = ~find_byte_mask(load(begin), needle))
+						return begin + std::countr_zero(mask);
+				return sse2_impl::skip_byte(begin, end, ch);
+			}
+
+			RU_AVX2 char const* find_line_end(char const* begin, char const* end) noexcept
+			{
+				for (; end - begin >= 32; begin += 32)
+					if (uint32_t const mask = line_end_mask(load(begin)))
+						return begin + std::countr_zero(mask);
+				return sse2_impl::find_line_end(begin, end);
+			}
+
+			RU_AVX2 char const* skip_ascii_word(char const* begin, char const* end) noexcept
+			{
+				for (; end - begin >= 32; begin += 32)
+					if (uint32_t const mask = non_word_mask(load(begin)))
+						return begin + std::countr_zero(mask);
+				return sse2_impl::skip_ascii_word(begin, end);
+			}
+
+			RU_AVX2 size_t count_code_points(char const* begin, char const* end) noexcept
+			{
+				auto count = 0uz;
+				for (; end - begin >= 32; begin += 32)
+					count += 32u - std::popcount(continuation_mask(load(begin)));
+				return count + sse2_impl::count_code_points(begin, end);
+			}
+
+			/// The classes of the errors a pair of bytes may make, for the lookups by their nibbles
+			/// (the validation of Keiser and Lemire, "Validating UTF-8 in less than one instruction per byte")
+			constexpr uint8_t too_short = 1u << 0;  // 11______ 0_______ or 11______ 11______
+			constexpr uint8_t too_long = 1u << 1;   // 0_______ 10______
+			constexpr uint8_t overlong_3 = 1u << 2; // 11100000 100_____
+			constexpr uint8_t too_large = 1u << 3;  // 11110100 1001____ or 11110100 101_____ or 11110101+ 10______
+			constexpr uint8_t surrogate = 1u << 4;  // 11101101 101_____
+			constexpr uint8_t overlong_2 = 1u << 5; // 1100000_ 10______
+			constexpr uint8_t too_large_1000 = 1u << 6; // 11110101+ 1000____
+			constexpr uint8_t overlong_4 = 1u << 6; // 11110000 1000____
+			constexpr uint8_t two_conts = 1u << 7;  // 10______ 10______
+			/// The errors the low nibble of the first byte doesn't decide
+			constexpr uint8_t carry = too_short | too_long | two_conts;
+
+			/// By the high nibble of the first byte
+			constexpr uint8_t first_high[16]
+			{
+				too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+				two_conts, two_conts, two_conts, two_conts,
+				too_short | overlong_2,
+				too_short,
+				too_short | overlong_3 | surrogate,
+				too_short | too_large | too_large_1000 | overlong_4,
+			};
+
+			/// By the low nibble of the first byte
+			constexpr uint8_t first_low[16]
+			{
+				carry | overlong_3 | overlong_2 | overlong_4,
+				carry | overlong_2,
+				carry,
+				carry,
+				carry | too_large,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000 | surrogate,
+				carry | too_large | too_large_1000,
+				carry | too_large | too_large_1000,
+			};
+
+			/// By the high nibble of the second byte
+			constexpr uint8_t second_high[16]
+			{
+				too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+				too_long | overlong_2 | two_conts | overlong_3 | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_long | overlong_2 | two_conts | surrogate | too_large,
+				too_short, too_short, too_short, too_short,
+			};
+
+			RU_AVX2 inline __m256i lookup(uint8_t const (&table)[16], __m256i nibbles) noexcept
+			{
+				auto const lane = _mm_loadu_si128(reinterpret_cast<__m128i const*>(table));
+				return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(lane), nibbles);
+			}
+
+			RU_AVX2 inline __m256i high_nibbles(__m256i v) noexcept
+			{
+				return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+			}
+
+			/// The bytes of @p input moved up by @c N, the last ones of @p previous coming in
+			template <int N>
+			RU_AVX2 inline __m256i shifted_in(__m256i input, __m256i previous) noexcept
+			{
+				return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+			}
+
+			/// @return Non-zero bytes where @p input, following @p previous, breaks UTF-8
+			RU_AVX2 inline __m256i utf8_errors(__m256i input, __m256i previous) noexcept
+			{
+				auto const previous_1 = shifted_in<1>(input, previous);
+				auto const pairs = _mm256_and_si256(
+					_mm256_and_si256(
+						lookup(first_high, high_nibbles(previous_1)),
+						lookup(first_low, _mm256_and_si256(previous_1, _mm256_set1_epi8(0x0F)))),
+					lookup(second_high, high_nibbles(input)));
+
+				// the third and the fourth bytes of a sequence must be continuations, which the pairs take for two_conts
+				auto const third = _mm256_subs_epu8(shifted_in<2>(input, previous), _mm256_set1_epi8(char(0xE0u - 0x80u)));
+				auto const fourth = _mm256_subs_epu8(shifted_in<3>(input, previous), _mm256_set1_epi8(char(0xF0u - 0x80u)));
+				auto const must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(char(0x80u)));
+				return _mm256_xor_si256(must_continue, pairs);
+			}
+
+			/// @return Non-zero bytes where a sequence starting in the last 3 bytes of @p input runs past them
+			RU_AVX2 inline __m256i incomplete_at_end(__m256i input) noexcept
+			{
+				auto const max = _mm256_setr_epi8(
+					-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+					-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+					char(0xF0u - 1u), char(0xE0u - 1u), char(0xC0u - 1u));
+				return _mm256_subs_epu8(input, max);
+			}
+
+			/// Checks whole vectors and stops at the first one with an error,
+			/// the scalar kernel finds its exact place from the sequence the vector starts in
+			RU_AVX2 char const* validate_utf8(char const* begin, char const* end) noexcept
+			{
+				auto const first = begin;
+				auto previous = _mm256_setzero_si256();
+				auto incomplete = _mm256_setzero_si256();
+				for (; end - begin >= 32; begin += 32)
+				{
+					auto const input = load(begin);
+					// a sequence the vector before left incomplete is an error only when no continuation comes,
+					// utf8_errors checks the continuations of such a sequence itself
+					auto const error = movemask(input) == 0u ? incomplete : utf8_errors(input, previous);
+					if (not _mm256_testz_si256(error, error)) break;
+					incomplete = incomplete_at_end(input);
+					previous = input;
+				}
+
+				// the last sequence before the stop may run into it
+				auto from = begin;
+				for (auto at = begin; at != first and begin - at < 3;)
+					if ((*--at & 0xC0) != 0x80)
+					{
+						from = at;
+						break;
+					}
+				return scalar_impl::validate_utf8(from, end);
+			}
+
+			#undef RU_AVX2
+		}
+#endif
+
+		constexpr kernels scalar_kernels
+		{
+			.find_byte = scalar_impl::find_byte,
+			.skip_byte = scalar_impl::skip_byte,
+			.find_line_end = scalar_impl::find_line_end,
+			.skip_ascii_word = scalar_impl::skip_ascii_word,
+			.count_code_points = scalar_impl::count_code_points,
+			.validate_utf8 = scalar_impl::validate_utf8,
+		};
+
+#ifdef RU_SCAN_X86
+		constexpr kernels sse2_kernels
+		{
+			.find_byte = sse2_impl::find_byte,
+			.skip_byte = sse2_impl::skip_byte,
+			.find_line_end = sse2_impl::find_line_end,
+			.skip_ascii_word = sse2_impl::skip_ascii_word,
+			.count_code_points = sse2_impl::count_code_points,
+			.validate_utf8 = sse2_impl::validate_utf8,
+		};
+
+		constexpr kernels avx2_kernels
+		{
+			.find_byte = avx2_impl::find_byte,
+			.skip_byte = avx2_impl::skip_byte,
+			.find_line_end = avx2_impl::find_line_end,
+			.skip_ascii_word = avx2_impl::skip_ascii_word,
+			.count_code_points = avx2_impl::count_code_points,
+			.validate_utf8 = avx2_impl::validate_utf8,
+		};
+#endif
+
+		/// The supported sets, detected on the first call rather than during static initialization,
+		/// so a scan from another static initializer still finds them
+		std::vector<kernels const*> const& supported_kernels()
+		{
+			static auto const result = []
+			{
+				auto result = std::vector<kernels const*>{&scalar_kernels};
+#ifdef RU_SCAN_X86
+				__builtin_cpu_init();
+				if (__builtin_cpu_supports("sse2")) result.push_back(&sse2_kernels);
+				if (__builtin_cpu_supports("avx2")) result.push_back(&avx2_kernels);
+#endif
+				return result;
+			}();
+			return result;
+		}
+	}
+
+	kernels const& scalar() noexcept
+	{
+		return scalar_kernels;
+	}
+
+	kernels const& active() noexcept
+	{
+		// the widest supported set
+		static auto const& selected = *supported_kernels().back();
+		return selected;
+	}
+
+	std::span<kernels const* const> supported() noexcept
+	{
+		return supported_kernels();
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <span>
+
+namespace Ru::lexer::scan
+{
+	/// A set of byte scanning kernels sharing one instruction set
+	struct kernels
+	{
+		/// @return The first byte in [begin, end) equal to @c ch, or @c end
+		char const* (*find_byte)(char const* begin, char const* end, char ch) noexcept;
+		/// @return The first byte in [begin, end) not equal to @c ch, or @c end
+		char const* (*skip_byte)(char const* begin, char const* end, char ch) noexcept;
+		/// @return The first '\\r' or '\\n' in [begin, end), or @c end
+		char const* (*find_line_end)(char const* begin, char const* end) noexcept;
+		/// @return The first byte in [begin, end) out of [A-Za-z0-9_], or @c end
+		/// \note bytes above ASCII stop the scan, they have to be decoded by the caller
+		char const* (*skip_ascii_word)(char const* begin, char const* end) noexcept;
+		/// @return The number of UTF-8 code points in [begin, end): the bytes that are not continuation bytes
+		size_t (*count_code_points)(char const* begin, char const* end) noexcept;
+		/// @return The first byte of the first ill-formed UTF-8 sequence in [begin, end), or @c end.
+		/// Overlong forms, surrogates, code points above U+10FFFF and truncated sequences are ill-formed
+		char const* (*validate_utf8)(char const* begin, char const* end) noexcept;
+	};
+
+	/// The byte-by-byte kernels, the reference for the vectorized ones
+	kernels const& scalar() noexcept;
+
+	/// The kernels chosen for the running CPU (AVX2, SSE2 or scalar)
+	kernels const& active() noexcept;
+
+	/// All the kernel sets the running CPU supports, the scalar one first
+	std::span<kernels const* const> supported() noexcept;
+
+	inline char const* find_byte(char const* begin, char const* end, char ch) noexcept
+	{
+		return active().find_byte(begin, end, ch);
+	}
+
+	inline char const* skip_byte(char const* begin, char const* end, char ch) noexcept
+	{
+		return active().skip_byte(begin, end, ch);
+	}
+
+	inline char const* find_line_end(char const* begin, char const* end) noexcept
+	{
+		return active().find_line_end(begin, end);
+	}
+
+	inline char const* skip_ascii_word(char const* begin, char const* end) noexcept
+	{
+		return active().skip_ascii_word(begin, end);
+	}
+
+	inline size_t count_code_points(char const* begin, char const* end) noexcept
+	{
+		return active().count_code_points(begin, end);
+	}
+
+	inline char const* validate_utf8(char const* begin, char const* end) noexcept
+	{
+		return active().validate_utf8(begin, end);
+	}
+}
@@ -0,0 +1,278 @@
+#pragma once
+#include <span>
+#include <tuple>
+#include <vector>
+#include "../lexer.hpp"
+#include "keywords.hpp"
+#include "literals.hpp"
+#include "operators.hpp"
+#include "symbols.hpp"
+
+/// The pieces of the lexer shared by the staged and the fused pipelines
+namespace Ru::lexer
+{
+	/// The state of \c lex_raw, pulled one raw token at a time without a coroutine
+	struct RawLexer
+	{
+		explicit RawLexer(std::string_view input) noexcept;
+
+		/// Lexes the raw tokens that start in [@p from, @p stop) of the input, a part of a larger lexing.
+		/// A token may run past @p stop, the whole input is seen.
+		/// The text is checked to be UTF-8 a few lines at a time as it is lexed, once, and decoded with no checks.
+		/// An ill-formed sequence is an \c error_bad_utf8 token starting at it; when it falls in a token,
+		/// the token is cut there, as an \c error or an \c error_unclosed_string, and the error takes the rest of it
+		/// \note @p from is the start of the input or a place where \c lex_raw starts a token
+		RawLexer(std::string_view input, char const* from, char const* stop) noexcept;
+
+		/// @return The next raw token; the last one is always \c none
+		Token next() noexcept;
+
+		/// Whether every raw token, the final \c none included, is taken
+		bool done() const noexcept { return stage == stage::done; }
+
+		/// @return Where the taken tokens end, the place the next token would start at
+		char const* position() const noexcept { return begin; }
+
+	private:
+		enum class stage : uint_fast8_t { prologue, body, done };
+
+		/// Checks the lines after \c begin to be UTF-8
+		void check() noexcept;
+
+		/// @return @p token, which started at @p token_begin and ends at \c begin, cut at the ill-formed sequence at @p bad;
+		/// the error from it on is the next token
+		Token cut(Token const& token, char const* token_begin, char const* bad) noexcept;
+
+		char const* begin;
+		char const* stop;
+		char const* end;
+		/// Where the text checked to be UTF-8 ends
+		char const* checked;
+		/// The first ill-formed sequence at or after \c begin in the checked text, or \c checked
+		char const* invalid;
+		enum stage stage = stage::prologue;
+		/// The error of a cut token, given after it
+		Token pending = none;
+	};
+
+	/// @return The precedence of an operator deduced from its symbols
+	prec get_precision(std::string_view op);
+
+	/// A stage of \c lex_staged, one pass over the tokens of the stage before
+	struct lex_stage
+	{
+		std::string_view name;
+		/// @param interners Where the stages that give symbols intern, the others leave it
+		token_generator (*apply)(token_generator tokens, Interners& interners) noexcept;
+	};
+
+	/// The stages \c lex_staged chains after \c lex_raw, in order
+	std::span<lex_stage const> lex_stages() noexcept;
+
+	/// identifiers, dot_at_right, dot_at_left, operators: the stages that see one raw token at a time.
+	/// The names get their symbols in @p interners here, the literals their decoded values
+	/// @param push Called with each token the raw one turns into
+	template <class Push>
+	void classify(Token tok, Interners& interners, Push&& push)
+	{
+		if (tok.id == id::identifier)
+		{
+			if (auto const found = find_keyword(tok.as_text)) std::tie(tok.id, tok.prec) = *found;
+			else tok.symbol = interners.names.intern(tok.as_text);
+		}
+		else if (tok.id == id::id_expl) tok.symbol = interners.names.intern(tok.as_text);
+		else if (tok.id == id::string or tok.id == id::character) tok.symbol = intern_literal(literal_body(tok), interners.literals);
+		else if (tok.id == id::number and tok.number.kind == Number::kind::big_integer) keep_limbs(tok, interners.limbs);
+
+		if (tok.id != id::operator_) return push(tok);
+
+		auto const text = tok.as_text;
+		auto const right_dot = text.size() != 1u and text.back() == '.' and text.end()[-2] != '.';
+		if (right_dot) tok.as_text.remove_suffix(1u);
+
+		auto const left_dot = tok.as_text.size() != 1u and tok.as_text.front() == '.' and tok.as_text[1] != '.';
+		if (left_dot)
+		{
+			push(Token{
+				.id = id::op_dot,
+				.as_text = tok.as_text.substr(0u, 1u),
+			});
+			tok.as_text.remove_prefix(1u);
+		}
+
+		if (auto const found = find_keyword_operator(tok.as_text))
+			std::tie(tok.id, tok.prec) = *found;
+		push(tok);
+
+		if (right_dot) push(Token{
+			.id = id::op_dot,
+			.as_text = {text.end() - 1, text.end()},
+		});
+	}
+
+	/// The stages of \c lex_staged after \c classify as one state machine over the classified tokens.
+	/// Each token is pushed through the stages by plain calls, the stages that
+	/// look at the neighbours keep what they need of them
+	class FusedStages
+	{
+	public:
+		explicit FusedStages(OperatorTable& operators) noexcept
+			: operators(operators)
+		{}
+
+		/// Pushes a classified token, the tokens it completes are appended to the output
+		void push(Token const& tok) { push_mix(tok); }
+
+		/// Pushes out the token held back to be mixed with the next one, at the end of the input
+		/// @return false when no token was held
+		bool flush()
+		{
+			if (not has_pending) return false;
+			has_pending = false;
+			push_precedence(pending);
+			return true;
+		}
+
+		/// Takes the stages to where they were after a line of a text lexed before, as the text is lexed again from its end
+		/// @param open_indents The widths of the indents open at the line end, the outermost 0 first
+		/// @param last The last token that came out before the line end
+		void resume(std::span<size_t const> open_indents, Token const& last)
+		{
+			indents.assign(open_indents.begin(), open_indents.end());
+			has_pending = false;
+			out.clear();
+			indents_prev = indents_curr = invoke_prev = invoke_curr = last;
+		}
+
+		/// The widths of the open indents, the outermost 0 first
+		std::span<size_t const> open_indents() const noexcept { return indents; }
+		/// The last token that came out of the last stage, or \c none
+		Token const& last_output() const noexcept { return invoke_curr; }
+
+		/// The tokens that came out of the last stage since the output was cleared
+		std::span<Token const> output() const noexcept { return out; }
+		size_t output_size() const noexcept { return out.size(); }
+		void clear_output() noexcept { out.clear(); }
+
+	private:
+		static bool adjacent(Token const& left, Token const& right) noexcept
+		{
+			return left.as_text.data() + left.as_text.size() == right.as_text.data();
+		}
+
+		/// mix(op_move, kw_in, not_in), one token behind
+		void push_mix(Token const& tok)
+		{
+			if (has_pending and pending.id == id::op_move and tok.id == id::kw_in and adjacent(pending, tok))
+			{
+				auto copy = tok;
+				copy.id = id::not_in;
+				copy.as_text = {pending.as_text.begin(), tok.as_text.end()};
+				copy.prefix = pending.as_text.size();
+				has_pending = false;
+				return push_precedence(copy);
+			}
+
+			if (has_pending) push_precedence(pending);
+			pending = tok;
+			has_pending = true;
+		}
+
+		/// precedence, classifying every distinct operator once by the operator table
+		void push_precedence(Token tok)
+		{
+			if (tok.id == id::operator_)
+			{
+				tok.operator_index = operators.intern(tok.as_text);
+				tok.prec = tok.operator_index ? operators[tok.operator_index].prec : get_precision(tok.as_text);
+			}
+			else if (tok.id >= id::op_init and tok.id <= id::op_pair)
+				tok.operator_index = operators.intern(tok.as_text);
+			push_indents(tok);
+		}
+
+		/// indents
+		void push_indents(Token const& tok)
+		{
+			indents_prev = indents_curr;
+			indents_curr = tok;
+			if (tok.id == id::none)
+			{
+				// the indents still open are closed at the end of the input
+				auto dedent_tok = Token{
+					.id = id::dedent,
+					.prec = prec::close,
+					.as_text = {indents_prev.as_text.data() + indents_prev.as_text.size(), 0uz},
+				};
+				for (; indents.size() != 1u; indents.pop_back())
+					push_invoke(dedent_tok);
+			}
+			if (tok.id != id::newline) return push_invoke(tok);
+
+			auto const width = tok.as_text.size();
+			if (width > indents.back()) switch (indents_prev.prec)
+			{
+				default: break;
+				case prec::open:
+				case prec::inv_open:
+				case prec::and_:
+				case prec::or_:
+				case prec::while_:
+				case prec::exchange:
+				case prec::other:
+					auto indent_tok = tok;
+					indent_tok.id = id::indent;
+					indent_tok.prec = prec::open;
+					push_invoke(indent_tok);
+					indents.push_back(width);
+					break;
+			}
+			else
+			{
+				auto dedent_tok = tok;
+				dedent_tok.prec = prec::close;
+				dedent_tok.id = id::dedent;
+				while (width < indents.back())
+				{
+					push_invoke(dedent_tok);
+					indents.pop_back();
+				}
+
+				if (width == indents.back()) push_invoke(tok);
+			}
+		}
+
+		/// noexpl, invoke
+		void push_invoke(Token const& tok)
+		{
+			invoke_prev = invoke_curr;
+			invoke_curr = tok;
+
+			if (invoke_curr.id == id::id_expl) invoke_curr.id = id::identifier;
+			if (invoke_curr.id == id::op_expl) invoke_curr.id = id::operator_;
+
+			if (invoke_prev.id != id::op_dot
+			and (invoke_prev.prec == prec::close or invoke_prev.prec == prec::intern or invoke_prev.prec == prec::unary)
+			and adjacent(invoke_prev, invoke_curr))
+			{
+				if (invoke_curr.prec == prec::open)
+					invoke_curr.prec = prec::inv_open;
+				if (invoke_curr.prec == prec::intern)
+					invoke_curr.prec = prec::unary;
+			}
+
+			out.push_back(invoke_curr);
+		}
+
+		OperatorTable& operators;
+		std::vector<Token> out;
+
+		Token pending = none;
+		bool has_pending = false;
+
+		Token indents_prev = none, indents_curr = none;
+		std::vector<size_t> indents{0uz};
+
+		Token invoke_prev = none, invoke_curr = none;
+	};
+}
@@ -0,0 +1,222 @@
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "symbols.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		constexpr unsigned shard_bits = 6u;
+		constexpr size_t shard_count = 1uz << shard_bits;
+
+		/// The entries of a shard are kept in blocks of doubling sizes, so they never move
+		constexpr unsigned first_block_bits = 6u;
+		constexpr size_t block_count = 32u - shard_bits - first_block_bits + 1u;
+		/// The most entries a shard holds, as a symbol is the entry's index + 1 over the shard
+		constexpr size_t max_entries = (1uz << (32u - shard_bits)) - 1u;
+
+		constexpr size_t arena_block_size = 64uz << 10;
+		constexpr size_t first_table_size = 64u;
+
+		/// Mixes the spelling 8 bytes at a time, the names are mostly short
+		uint32_t hash(std::string_view spelling) noexcept
+		{
+			constexpr auto multiplier = 0x9E3779B97F4A7C15u;
+			auto hash = uint64_t(spelling.size()) * multiplier;
+			auto at = spelling.data();
+			auto left = spelling.size();
+			for (; left >= 8u; at += 8, left -= 8u)
+			{
+				uint64_t word;
+				std::memcpy(&word, at, 8u);
+				hash = (hash ^ word) * multiplier;
+				hash ^= hash >> 29u;
+			}
+			if (left != 0u)
+			{
+				auto word = uint64_t(0);
+				std::memcpy(&word, at, left);
+				hash = (hash ^ word) * multiplier;
+				hash ^= hash >> 29u;
+			}
+			return uint32_t(hash >> 32u) ^ uint32_t(hash);
+		}
+
+		struct entry
+		{
+			std::string_view spelling;
+			uint32_t hash;
+		};
+
+		/// An open addressing table of the entries of a shard, at most half full.
+		/// A slot is 0 or the entry's hash over its index + 1
+		struct table
+		{
+			explicit table(size_t size) : slots(size) {}
+
+			std::vector<std::atomic<uint64_t>> slots;
+
+			size_t mask() const noexcept { return slots.size() - 1u; }
+
+			/// Called by the writer of the shard only
+			void insert(uint32_t hash, uint32_t index) noexcept
+			{
+				auto slot = hash & mask();
+				while (slots[slot].load(std::memory_order_relaxed) != 0u) slot = (slot + 1u) & mask();
+				slots[slot].store(uint64_t(hash) << 32u | (index + 1u), std::memory_order_release);
+			}
+		};
+	}
+
+	struct Interner::shard
+	{
+		/// The table the readers take, the ones it replaced are kept for the readers still in them.
+		/// A shard has no table until its first entry, so an interner of a small text allocates little
+		std::atomic<table const*> current = nullptr;
+		std::atomic<entry*> blocks[block_count] = {};
+		std::atomic<uint32_t> count = 0u;
+
+		std::mutex adding;
+		std::vector<std::unique_ptr<table>> tables;
+		std::vector<std::unique_ptr<char[]>> arena;
+		char* arena_free = nullptr;
+		size_t arena_left = 0u;
+
+		~shard()
+		{
+			for (auto& block : blocks)
+				delete[] block.load(std::memory_order_relaxed);
+		}
+
+		static std::pair<size_t, size_t> locate(uint32_t index) noexcept
+		{
+			auto const biased = size_t(index) + (1uz << first_block_bits);
+			auto const block = size_t(std::bit_width(biased)) - first_block_bits - 1u;
+			return {block, biased - (1uz << (block + first_block_bits))};
+		}
+
+		entry const& at(uint32_t index) const noexcept
+		{
+			auto const [block, offset] = locate(index);
+			return blocks[block].load(std::memory_order_acquire)[offset];
+		}
+
+		/// @return The entry's index + 1, 0 when it isn't there
+		uint32_t find(std::string_view spelling, uint32_t hash) const noexcept
+		{
+			auto const* const taken = current.load(std::memory_order_acquire);
+			if (taken == nullptr) return 0u;
+			auto const& slots = *taken;
+			for (auto slot = hash & slots.mask();; slot = (slot + 1u) & slots.mask())
+			{
+				auto const value = slots.slots[slot].load(std::memory_order_acquire);
+				if (value == 0u) return 0u;
+				if (uint32_t(value >> 32u) == hash and at(uint32_t(value) - 1u).spelling == spelling)
+					return uint32_t(value);
+			}
+		}
+
+		std::string_view store(std::string_view spelling)
+		{
+			if (spelling.empty()) return {};
+			if (arena_left < spelling.size())
+			{
+				auto const size = std::max(arena_block_size, spelling.size());
+				arena.push_back(std::make_unique<char[]>(size));
+				arena_free = arena.back().get();
+				arena_left = size;
+			}
+			auto const stored = std::string_view(arena_free, spelling.size());
+			std::memcpy(arena_free, spelling.data(), spelling.size());
+			arena_free += spelling.size();
+			arena_left -= spelling.size();
+			return stored;
+		}
+
+		uint32_t add(std::string_view spelling, uint32_t hash)
+		{
+			auto const lock = std::lock_guard(adding);
+			if (auto const found = find(spelling, hash)) return found;
+
+			auto const index = count.load(std::memory_order_relaxed);
+			if (index == max_entries) throw std::length_error("Too many names");
+
+			auto const [block, offset] = locate(index);
+			if (offset == 0u) blocks[block].store(new entry[1uz << (block + first_block_bits)], std::memory_order_release);
+			blocks[block].load(std::memory_order_relaxed)[offset] = {store(spelling), hash};
+			count.store(index + 1u, std::memory_order_release);
+
+			if (tables.empty())
+			{
+				tables.push_back(std::make_unique<table>(first_table_size));
+				tables.back()->insert(hash, index);
+				current.store(tables.back().get(), std::memory_order_release);
+				return index + 1u;
+			}
+
+			auto& slots = *tables.back();
+			if (size_t(index + 1u) * 2u <= slots.slots.size())
+			{
+				slots.insert(hash, index);
+				return index + 1u;
+			}
+
+			// The readers go on in the table they have, which holds every entry but the new one
+			auto grown = std::make_unique<table>(slots.slots.size() * 2u);
+			for (auto i = 0u; i <= index; ++i)
+				grown->insert(at(i).hash, i);
+			current.store(grown.get(), std::memory_order_release);
+			tables.push_back(std::move(grown));
+			return index + 1u;
+		}
+	};
+
+	Interner::Interner()
+		: shards(std::make_unique<shard[]>(shard_count))
+	{}
+
+	Interner::~Interner() = default;
+
+	Symbol Interner::intern(std::string_view spelling)
+	{
+		auto const h = hash(spelling);
+		auto const index = h >> (32u - shard_bits);
+		auto& in = shards[index];
+		auto found = in.find(spelling, h);
+		if (found == 0u) found = in.add(spelling, h);
+		return Symbol(found << shard_bits | index);
+	}
+
+	Symbol Interner::find(std::string_view spelling) const noexcept
+	{
+		auto const h = hash(spelling);
+		auto const index = h >> (32u - shard_bits);
+		auto const found = shards[index].find(spelling, h);
+		return found == 0u ? Symbol::none : Symbol(found << shard_bits | index);
+	}
+
+	std::string_view Interner::spelling(Symbol symbol) const noexcept
+	{
+		auto const value = std::to_underlying(symbol);
+		if (value == 0u) return {};
+		return shards[value & (shard_count - 1u)].at((value >> shard_bits) - 1u).spelling;
+	}
+
+	size_t Interner::size() const noexcept
+	{
+		auto result = 0uz;
+		for (auto i = 0uz; i != shard_count; ++i)
+			result += shards[i].count.load(std::memory_order_relaxed);
+		return result;
+	}
+
+	std::span<uint64_t const> LimbStore::keep(std::vector<uint64_t>&& limbs)
+	{
+		auto const lock = std::lock_guard(adding);
+		return kept.emplace_back(std::move(limbs));
+	}
+}
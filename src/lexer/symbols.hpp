@@ -0,0 +1,64 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+#include "../lexer.hpp"
+
+namespace Ru::lexer
+{
+	/// Maps the distinct spellings of names to 32-bit symbols, for the threads lexing at once to share.
+	/// The spellings are spread over shards: finding one takes no lock, adding one locks its shard
+	class Interner
+	{
+	public:
+		Interner();
+		~Interner();
+		Interner(Interner const&) = delete;
+		void operator=(Interner const&) = delete;
+
+		/// Finds or adds a spelling
+		/// @throw std::length_error when a shard is out of symbols
+		Symbol intern(std::string_view spelling);
+
+		/// @return The symbol of a spelling, \c Symbol::none when it isn't interned
+		Symbol find(std::string_view spelling) const noexcept;
+
+		/// @return The spelling of a symbol, kept as long as the interner
+		std::string_view spelling(Symbol symbol) const noexcept;
+
+		/// @return The number of the distinct spellings
+		size_t size() const noexcept;
+
+	private:
+		struct shard;
+		std::unique_ptr<shard[]> shards;
+	};
+
+	/// Keeps the limbs of the integer literals too big for 64 bits, for the threads lexing at once to share
+	class LimbStore
+	{
+	public:
+		/// @return The limbs, kept as long as the store
+		std::span<uint64_t const> keep(std::vector<uint64_t>&& limbs);
+
+	private:
+		std::mutex adding;
+		std::deque<std::vector<uint64_t>> kept;
+	};
+
+	/// What a compilation interns as it is lexed, passed to the lexer as its \c OperatorTable is.
+	/// The symbols of the tokens are those of the interners, they live as long as the compilation
+	struct Interners
+	{
+		/// The spellings of the names
+		Interner names;
+		/// The decoded values of the string and character literals, each distinct one once
+		Interner literals;
+		/// The limbs of the big integer literals
+		LimbStore limbs;
+	};
+}
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "token_buffer.hpp"
+
+namespace Ru::lexer
+{
+	/// The offset of the tokens with no text, as \c none
+	static constexpr auto no_text = std::numeric_limits<uint32_t>::max();
+
+	/// @return @p value as a 32-bit offset or length, below \c no_text
+	/// @throw std::length_error when the text is too large for it
+	static uint32_t narrow(ptrdiff_t value)
+	{
+		if (value < 0 or value >= ptrdiff_t(no_text)) throw std::length_error("The text is too large for a token buffer");
+		return uint32_t(value);
+	}
+
+	/// Replaces the elements [first, last) of a vector, moving the ones after them once
+	template <class T>
+	static void replace(std::vector<T>& into, size_t first, size_t last, std::vector<T> const& with)
+	{
+		auto const common = std::min(last - first, with.size());
+		std::copy_n(with.begin(), common, into.begin() + first);
+		if (with.size() > common) into.insert(into.begin() + first + common, with.begin() + common, with.end());
+		else into.erase(into.begin() + first + common, into.begin() + last);
+	}
+
+	TokenBuffer::TokenBuffer(token_generator tokens)
+	{
+		for (auto const& tok : tokens)
+			push_back(tok);
+	}
+
+	TokenBuffer::TokenBuffer(batch_generator batches)
+	{
+		for (auto const& batch : batches)
+		{
+			reserve(size() + batch.size());
+			for (auto const& tok : batch)
+				push_back(tok);
+		}
+	}
+
+	void TokenBuffer::reserve(size_t size)
+	{
+		_ids.reserve(size);
+		_precs.reserve(size);
+		_offsets.reserve(size);
+		_lengths.reserve(size);
+		_operator_indices.reserve(size);
+		_symbols.reserve(size);
+		_extras.reserve(size);
+	}
+
+	void TokenBuffer::push_back(Token const& tok)
+	{
+		// checked before any column grows, a token too large leaves the buffer as it was
+		auto const length = narrow(ptrdiff_t(tok.as_text.size()));
+		auto offset = no_text;
+		if (tok.as_text.data() != nullptr)
+		{
+			// The text is counted from the first token, the tokens come in the order of the text
+			if (base == nullptr) base = tok.as_text.data();
+			offset = narrow(tok.as_text.data() - base);
+		}
+
+		auto extra = 0u;
+		if (tok.prefix != 0 or tok.postfix != 0 or tok.shift != 0 or tok.number.kind != Number::kind::none)
+		{
+			extra = uint32_t(side_table.size());
+			side_table.push_back({.prefix = tok.prefix, .postfix = tok.postfix, .shift = tok.shift, .number = tok.number});
+		}
+
+		_ids.push_back(tok.id);
+		_precs.push_back(tok.prec);
+		_offsets.push_back(offset);
+		_lengths.push_back(length);
+		_operator_indices.push_back(tok.operator_index);
+		_symbols.push_back(tok.symbol);
+		_extras.push_back(extra);
+	}
+
+	void TokenBuffer::splice(size_t first, size_t last, std::span<Token const> replacement, ptrdiff_t shift, char const* origin)
+	{
+		auto added = TokenBuffer();
+		added.base = origin;
+		added.reserve(replacement.size());
+		for (auto const& tok : replacement)
+			added.push_back(tok);
+
+		// the offsets grow in the order of the text, the last one tells whether they all fit, before any is changed
+		auto const texts = std::span(_offsets).subspan(last);
+		if (auto const last_text = std::ranges::find_if(texts.rbegin(), texts.rend(), [](uint32_t offset) { return offset != no_text; });
+			last_text != texts.rend())
+			narrow(*last_text + shift);
+
+		base = origin;
+		for (auto& offset : texts)
+			if (offset != no_text) offset = uint32_t(offset + shift);
+
+		// The side table entries of the replacement go after ours
+		auto const extras_base = uint32_t(side_table.size() - 1u);
+		for (auto& extra : added._extras)
+			if (extra != 0u) extra += extras_base;
+		side_table.insert(side_table.end(), added.side_table.begin() + 1, added.side_table.end());
+		dead_extras += size_t(std::count_if(_extras.begin() + first, _extras.begin() + last, [](uint32_t extra) { return extra != 0u; }));
+
+		replace(_ids, first, last, added._ids);
+		replace(_precs, first, last, added._precs);
+		replace(_offsets, first, last, added._offsets);
+		replace(_lengths, first, last, added._lengths);
+		replace(_operator_indices, first, last, added._operator_indices);
+		replace(_symbols, first, last, added._symbols);
+		replace(_extras, first, last, added._extras);
+
+		if (dead_extras * 2u <= side_table.size()) return;
+
+		// Most of the side table is of tokens spliced out, it is made anew
+		auto table = std::vector<TokenExtra>(1u);
+		for (auto& extra : _extras)
+			if (extra != 0u)
+			{
+				table.push_back(side_table[extra]);
+				extra = uint32_t(table.size() - 1u);
+			}
+		side_table = std::move(table);
+		dead_extras = 0u;
+	}
+
+	CompactToken TokenBuffer::compact(size_t index) const noexcept
+	{
+		return {
+			.offset = _offsets[index],
+			.length = _lengths[index],
+			.id = _ids[index],
+			.prec = _precs[index],
+			.operator_index = _operator_indices[index],
+			.extra = _extras[index],
+		};
+	}
+
+	Token TokenBuffer::operator[](size_t index) const noexcept
+	{
+		auto const& extra = side_table[_extras[index]];
+		auto const offset = _offsets[index];
+		auto const has_text = offset != no_text;
+
+		return {
+			.id = _ids[index],
+			.prec = _precs[index],
+			.operator_index = _operator_indices[index],
+			.symbol = _symbols[index],
+			.as_text = has_text ? std::string_view(base + offset, _lengths[index]) : std::string_view(),
+			.prefix = extra.prefix,
+			.postfix = extra.postfix,
+			.shift = extra.shift,
+			.number = extra.number,
+		};
+	}
+}
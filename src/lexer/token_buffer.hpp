@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
+#include "../lexer.hpp"
+
+namespace Ru::lexer
+{
+	/// @brief A Token packed into 16 bytes, positions are offsets in the buffer's text
+	struct CompactToken
+	{
+		/// The offset of the text from the buffer's first token
+		uint32_t offset;
+		/// The length of the text
+		uint32_t length;
+		id id;
+		prec prec;
+		uint16_t operator_index;
+		/// The Token's entry in the buffer's side table, 0 when it has none
+		uint32_t extra;
+	};
+	static_assert(sizeof(CompactToken) == 16u);
+
+	/// @brief The rarely set fields of a Token
+	struct TokenExtra
+	{
+		intptr_t prefix = 0;
+		intptr_t postfix = 0;
+		int64_t shift = 0;
+		Number number = {};
+	};
+
+	/// A sequence of tokens kept by fields: ids, precs, offsets, lengths and symbols in their own arrays,
+	/// the rarely set fields in a side table. A text of up to 4 GiB is supported
+	class TokenBuffer
+	{
+	public:
+		class iterator;
+
+		TokenBuffer() = default;
+		explicit TokenBuffer(token_generator tokens);
+		explicit TokenBuffer(batch_generator batches);
+
+		/// @throw std::length_error when the token is 4 GiB or more past the first one
+		void push_back(Token const& tok);
+		void reserve(size_t size);
+
+		/// Replaces the tokens [@p first, @p last) by @p replacement after an edit of the text past the first token
+		/// @param shift How many bytes the text of the tokens after @p last moved by
+		/// @param origin Where the text of the first token is in the edited text
+		/// @throw std::length_error when the edited text of the tokens passes 4 GiB
+		void splice(size_t first, size_t last, std::span<Token const> replacement, ptrdiff_t shift, char const* origin);
+
+		size_t size() const noexcept { return _ids.size(); }
+		bool empty() const noexcept { return _ids.empty(); }
+
+		/// @return The token rebuilt with every field
+		Token operator[](size_t index) const noexcept;
+		CompactToken compact(size_t index) const noexcept;
+
+		std::span<id const> ids() const noexcept { return _ids; }
+		std::span<prec const> precs() const noexcept { return _precs; }
+		std::span<uint32_t const> offsets() const noexcept { return _offsets; }
+		std::span<uint32_t const> lengths() const noexcept { return _lengths; }
+		std::span<uint16_t const> operator_indices() const noexcept { return _operator_indices; }
+		std::span<Symbol const> symbols() const noexcept { return _symbols; }
+
+		/// @return Where the offsets count from: the text of the first token
+		char const* origin() const noexcept { return base; }
+
+		iterator begin() const noexcept;
+		iterator end() const noexcept;
+
+	private:
+		char const* base = nullptr;
+		std::vector<id> _ids;
+		std::vector<prec> _precs;
+		std::vector<uint32_t> _offsets;
+		std::vector<uint32_t> _lengths;
+		std::vector<uint16_t> _operator_indices;
+		std::vector<Symbol> _symbols;
+		std::vector<uint32_t> _extras;
+		std::vector<TokenExtra> side_table{1u};
+		/// The side table entries of the tokens spliced out
+		size_t dead_extras = 0u;
+	};
+
+	/// Iterates the tokens of a buffer: -> gives the compact form and * the rebuilt Token
+	class TokenBuffer::iterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = Token;
+		using reference = Token;
+		using difference_type = ptrdiff_t;
+
+		struct pointer
+		{
+			CompactToken compact;
+			CompactToken const* operator->() const noexcept { return &compact; }
+		};
+
+		iterator() noexcept = default;
+		iterator(TokenBuffer const& buffer, size_t index) noexcept : buffer(&buffer), index(index) {}
+
+		Token operator*() const noexcept { return (*buffer)[index]; }
+		pointer operator->() const noexcept { return {buffer->compact(index)}; }
+		iterator& operator++() noexcept { ++index; return *this; }
+		iterator operator++(int) noexcept { auto copy = *this; ++index; return copy; }
+		difference_type operator-(iterator other) const noexcept { return difference_type(index - other.index); }
+		bool operator==(iterator const& other) const noexcept { return index == other.index; }
+
+	private:
+		TokenBuffer const* buffer = nullptr;
+		size_t index = 0u;
+	};
+
+	inline TokenBuffer::iterator TokenBuffer::begin() const noexcept { return {*this, 0u}; }
+	inline TokenBuffer::iterator TokenBuffer::end() const noexcept { return {*this, size()}; }
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include "token_ring.hpp"
+
+namespace Ru::lexer
+{
+	namespace
+	{
+		/// The loads a side spins for before it sleeps, the other side is usually a block away
+		constexpr unsigned spin_count = 64u;
+
+		/// Waits for @p counter to change from @p seen
+		/// @return Its new value
+		size_t wait_change(std::atomic<size_t> const& counter, size_t seen) noexcept
+		{
+			for (auto i = 0u; i != spin_count; ++i)
+				if (auto const now = counter.load(std::memory_order_acquire); now != seen) return now;
+			counter.wait(seen, std::memory_order_acquire);
+			return counter.load(std::memory_order_acquire);
+		}
+	}
+
+	TokenRing::TokenRing(size_t block_count, size_t block_size)
+		: blocks(std::max(block_count, 1uz))
+	{
+		for (auto& block : blocks)
+			block.reserve(block_size);
+	}
+
+	std::vector<Token>* TokenRing::acquire_write() noexcept
+	{
+		auto const published = head.load(std::memory_order_relaxed);
+		auto released = tail.load(std::memory_order_acquire);
+		while ((released & closed) == 0u and published - released == blocks.size())
+			released = wait_change(tail, released);
+		if ((released & closed) != 0u) return nullptr;
+
+		auto& block = blocks[published % blocks.size()];
+		block.clear();
+		return &block;
+	}
+
+	void TokenRing::publish() noexcept
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+		head.notify_one();
+	}
+
+	void TokenRing::close_write() noexcept
+	{
+		head.fetch_or(closed, std::memory_order_release);
+		head.notify_one();
+	}
+
+	std::vector<Token> const* TokenRing::acquire_read() noexcept
+	{
+		auto const released = tail.load(std::memory_order_relaxed);
+		auto published = head.load(std::memory_order_acquire);
+		while ((published & ~closed) == released)
+		{
+			if ((published & closed) != 0u) return nullptr;
+			published = wait_change(head, published);
+		}
+		return &blocks[released % blocks.size()];
+	}
+
+	void TokenRing::release() noexcept
+	{
+		tail.store(tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+		tail.notify_one();
+	}
+
+	void TokenRing::close_read() noexcept
+	{
+		tail.fetch_or(closed, std::memory_order_release);
+		tail.notify_one();
+	}
+}
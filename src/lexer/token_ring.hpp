@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <vector>
+#include "../lexer.hpp"
+
+namespace Ru::lexer
+{
+	/// A bounded ring of token blocks from one lexing thread to one parsing thread, with no locks.
+	/// The producer fills the block past the last published one and publishes it,
+	/// the consumer reads the oldest published block and releases it.
+	/// A side blocks while the ring is full or empty, until the other side moves or closes
+	class TokenRing
+	{
+	public:
+		explicit TokenRing(size_t block_count = default_ring_blocks, size_t block_size = default_batch_size);
+
+		TokenRing(TokenRing const&) = delete;
+		void operator=(TokenRing const&) = delete;
+
+		/// Called by the producer; waits for a free block
+		/// @return The block to fill, emptied, or @c nullptr when the consumer has closed the ring
+		std::vector<Token>* acquire_write() noexcept;
+		/// Called by the producer; makes the block taken by \c acquire_write readable
+		void publish() noexcept;
+		/// Called by the producer; no block follows the published ones
+		void close_write() noexcept;
+
+		/// Called by the consumer; waits for a published block
+		/// @return The oldest published block, or @c nullptr once the producer has closed the ring and every block is read
+		std::vector<Token> const* acquire_read() noexcept;
+		/// Called by the consumer; gives the block taken by \c acquire_read back to the producer
+		void release() noexcept;
+		/// Called by the consumer; no block is read anymore, a producer waiting for a free block gives up
+		void close_read() noexcept;
+
+	private:
+		/// Set in a counter by its side when it closes, which wakes the other side waiting for it to change
+		static constexpr size_t closed = size_t(1) << (sizeof(size_t) * 8u - 1u);
+
+		std::vector<std::vector<Token>> blocks;
+		/// The number of blocks published, written by the producer only, a cache line apart from \c tail
+		alignas(64) std::atomic<size_t> head = 0u;
+		/// The number of blocks released, written by the consumer only
+		alignas(64) std::atomic<size_t> tail = 0u;
+	};
+}
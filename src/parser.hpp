@@ -1,8 +1,57 @@
 #pragma once
+#include <vector>
 #include "lexer.hpp"
+#include "lexer/token_buffer.hpp"
 #include "ast/ast.hpp"
 
 namespace Ru::parse
 {
+	/// What is wrong with a text the parser recovered from
+	enum class syntax_error : uint8_t
+	{
+		unclosed_brace,   ///< an opening brace with no closing one before its block or the text ends
+		unexpected_close, ///< a closing brace of nothing
+	};
+
+	struct Diagnostic
+	{
+		syntax_error error;
+		/// The brace the error is about, its text tells where it is
+		Ru::lexer::Token at;
+	};
+
+	/// Parses the tokens as they are generated, keeping the few the parser looks ahead at and no more
 	Ru::ast::ExpressionPtr parse(Ru::lexer::token_generator);
+	/// Parses the tokens as they are generated, copying the few it looks ahead at out of a batch before the next one comes
+	Ru::ast::ExpressionPtr parse(Ru::lexer::batch_generator);
+	Ru::ast::ExpressionPtr parse(Ru::lexer::TokenBuffer const&);
+
+	/// Parses recovering from the syntax errors: each one is added to @p diagnostics, in the order of the text,
+	/// and its part of the text becomes an \c ast::Expression::error; the parse goes on from the next line end,
+	/// dedent or \c ; after it
+	/// @return The tree of the whole text, \c nullptr only when it has no expression
+	Ru::ast::ExpressionPtr parse(Ru::lexer::token_generator, std::vector<Diagnostic>& diagnostics);
+	Ru::ast::ExpressionPtr parse(Ru::lexer::batch_generator, std::vector<Diagnostic>& diagnostics);
+	Ru::ast::ExpressionPtr parse(Ru::lexer::TokenBuffer const&, std::vector<Diagnostic>& diagnostics);
+
+	/// The default number of tokens a part of \c parse_parallel starts with
+	inline constexpr size_t default_part_size = 1uz << 14;
+
+	/// Parses the top-level items of a text on a thread pool, parts of them at a time. The parts end at
+	/// the line ends and \c ; out of any brace and block, so each part parses as it would in the whole text
+	/// @return The same tree as \c parse gives
+	Ru::ast::ExpressionPtr parse_parallel (
+		Ru::lexer::TokenBuffer const& tokens,
+		size_t part_size = default_part_size ///< The least number of tokens in a part, the last one may be shorter
+	);
+
+	/// Parses the top-level items of a text on a thread pool, recovering from the syntax errors as \c parse does
+	Ru::ast::ExpressionPtr parse_parallel (
+		Ru::lexer::TokenBuffer const& tokens,
+		std::vector<Diagnostic>& diagnostics,
+		size_t part_size = default_part_size ///< The least number of tokens in a part, the last one may be shorter
+	);
+
+	/// Parses a text while it is lexed ahead on another thread, see \c Ru::lexer::lex_pipelined
+	Ru::ast::ExpressionPtr parse_pipelined(std::string_view input, Ru::lexer::OperatorTable& operators, Ru::lexer::Interners& interners);
 }
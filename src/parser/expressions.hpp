@@ -0,0 +1,527 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "../ast/ast.hpp"
+#include "../lexer.hpp"
+#include "../lexer/token_buffer.hpp"
+#include "../parser.hpp"
+
+namespace Ru::parse
+{
+	using lexer::Token;
+	using lexer::id;
+	using lexer::prec;
+	using lexer::dir;
+
+	/// The level of the juxtaposition \code f a \endcode, the one \c prec::intern is commented out with
+	inline constexpr uint_fast8_t apply_level = 2u;
+	/// The level of the separators of a sequence, a line end and \c ;
+	inline constexpr uint_fast8_t sequence_level = std::to_underlying(prec::semicolon) >> 2;
+
+	/// How a token binds, read from the bits its \c prec packs
+	struct binding
+	{
+		/// From 1, the tightest, to the sequence level, the loosest; 0 for the tokens that are not operators
+		uint_fast8_t level = 0u;
+		dir associativity = dir::left;
+		/// The side the operator stands on when it has one operand
+		dir unary_side = dir::right;
+		/// Binds looser than a juxtaposition, so it is never an operand of one
+		bool is_operator = false;
+		/// An operator that can stand on the left of an operand, as a prefix
+		bool is_prefix = false;
+		/// \c prec::open or \c prec::inv_open
+		bool is_open = false;
+
+		static constexpr binding of(prec prec) noexcept
+		{
+			switch (prec)
+			{
+				case prec::intern:
+				case prec::close:
+					return {};
+				case prec::open:
+				case prec::inv_open:
+					return {.is_open = true};
+				// # => := and the trees bind their operands as a while does, both of them
+				case prec::other:
+				case prec::tree:
+					return {std::to_underlying(prec::while_) >> 2, dir::right, dir::right, true, false};
+				default:
+					auto const level = uint_fast8_t(std::to_underlying(prec) >> 2);
+					auto const unary_side = lexer::unary_side(prec);
+					return {
+						level, lexer::associativity(prec), unary_side,
+						level > apply_level,
+						level > apply_level and level < sequence_level and unary_side == dir::left,
+					};
+			}
+		}
+	};
+
+	static_assert(sizeof(prec) == 1u, "The bindings are a table of every prec");
+
+	/// The binding of each \c prec, made at compile time, so a parse has nothing to set up
+	/// and every thread reads the same table
+	inline constexpr auto bindings = []
+	{
+		auto table = std::array<binding, 256u>{};
+		for (auto i = 0u; i != table.size(); ++i)
+			table[i] = binding::of(prec(i));
+		return table;
+	}();
+
+	inline binding const& bind(prec prec) noexcept
+	{
+		return bindings[std::to_underlying(prec)];
+	}
+
+	/// @return The bracket that closes the opening brace @p open: ')', ']' or '}'; 0 for an indent
+	inline char closing_bracket(std::string_view open) noexcept
+	{
+		auto const at = open.find_first_of("([{");
+		if (at == open.npos) return '\0';
+		return open[at] == '(' ? ')' : open[at] == '[' ? ']' : '}';
+	}
+
+	/// @return The bracket the closing brace @p close is made of: ')', ']' or '}'; 0 for a dedent
+	inline char bracket_of(std::string_view close) noexcept
+	{
+		auto const at = close.find_first_of(")]}");
+		return at == close.npos ? '\0' : close[at];
+	}
+
+	/// Reads the tokens of a buffer by the fields the parser decides on
+	class BufferCursor
+	{
+	public:
+		explicit BufferCursor(lexer::TokenBuffer const& tokens) noexcept
+			: BufferCursor(tokens, 0u, tokens.size())
+		{}
+
+		/// Reads the tokens [@p first, @p last) of @p tokens, as if the others were not there
+		BufferCursor(lexer::TokenBuffer const& tokens, size_t first, size_t last) noexcept
+			: tokens(tokens)
+			, at(first)
+			, stop(last)
+		{}
+
+		/// @return The id of the token @p ahead of the next one, \c id::none past the end
+		id peek_id(size_t ahead = 0u) const noexcept
+		{
+			return at + ahead < stop ? tokens.ids()[at + ahead] : id::none;
+		}
+
+		prec peek_prec(size_t ahead = 0u) const noexcept
+		{
+			return at + ahead < stop ? tokens.precs()[at + ahead] : prec::intern;
+		}
+
+		/// @return The text of the next token, empty past the end
+		std::string_view peek_text() const noexcept
+		{
+			return at < stop ? tokens[at].as_text : std::string_view();
+		}
+
+		Token take() noexcept { return tokens[at++]; }
+
+	private:
+		lexer::TokenBuffer const& tokens;
+		size_t at, stop;
+	};
+
+	/// The most tokens the parser looks at past the ones it has taken
+	inline constexpr size_t lookahead = 3u;
+
+	/// Reads the tokens of a sequence as it is generated, one token or one batch at a time.
+	/// Only the \c lookahead tokens the parser may still look at are kept, so a text of any length
+	/// is parsed in the same memory as its lexer takes
+	/// @tparam Generator \c lexer::token_generator or \c lexer::batch_generator
+	template <class Generator>
+	class StreamCursor
+	{
+	public:
+		explicit StreamCursor(Generator tokens) noexcept
+			: tokens(std::move(tokens))
+			, it(this->tokens.begin())
+		{}
+
+		StreamCursor(StreamCursor const&) = delete;
+		void operator=(StreamCursor const&) = delete;
+
+		id peek_id(size_t ahead = 0u) noexcept
+		{
+			return fill(ahead) ? window[(first + ahead) % lookahead].id : id::none;
+		}
+
+		prec peek_prec(size_t ahead = 0u) noexcept
+		{
+			return fill(ahead) ? window[(first + ahead) % lookahead].prec : prec::intern;
+		}
+
+		std::string_view peek_text() noexcept
+		{
+			return fill(0u) ? window[first].as_text : std::string_view();
+		}
+
+		Token take() noexcept
+		{
+			fill(0u);
+			auto const tok = window[first];
+			first = (first + 1u) % lookahead;
+			--count;
+			return tok;
+		}
+
+	private:
+		/// Pulls the tokens up to @p ahead into the window
+		/// @return false when the sequence ends before
+		bool fill(size_t ahead) noexcept
+		{
+			while (count <= ahead)
+			{
+				if (not pull(window[(first + count) % lookahead])) return false;
+				++count;
+			}
+			return true;
+		}
+
+		/// Copies the next token out of the generator, before it is resumed and the token is gone
+		bool pull(Token& tok) noexcept
+		{
+			if constexpr (std::same_as<Generator, lexer::token_generator>)
+			{
+				if (not it) return false;
+				tok = *it;
+				++it;
+			}
+			else
+			{
+				while (at == batch.size())
+				{
+					if (started) ++it;
+					started = true;
+					if (not it) return false;
+					batch = *it;
+					at = 0u;
+				}
+				tok = batch[at++];
+			}
+			return true;
+		}
+
+		Generator tokens;
+		Generator::iterator it;
+		std::array<Token, lookahead> window = []<size_t... i>(std::index_sequence<i...>)
+		{
+			return std::array{(void(i), lexer::none)...};
+		}(std::make_index_sequence<lookahead>());
+		/// The window is a ring of \c count tokens from \c first
+		size_t first = 0u, count = 0u;
+
+		/// The batch being read, of a batch generator
+		lexer::token_batch batch;
+		size_t at = 0u;
+		bool started = false;
+	};
+
+	/// A precedence climbing parser of the expressions of a token sequence.
+	/// Each token is looked at a bounded number of times, up to \c lookahead tokens ahead, and is never gone back to.
+	/// The binary operators bind by their \c binding, the juxtaposition \code f a \endcode at \c apply_level
+	/// and the tokens right after the previous one, \c prec::unary and \c prec::inv_open, tighter than anything
+	/// @tparam Cursor Gives \c peek_id, \c peek_prec, \c peek_text and \c take as \c BufferCursor and \c StreamCursor do
+	template <class Cursor>
+	class ExpressionParser
+	{
+	public:
+		using Expression = ast::Expression;
+		using ptr_type = Expression::ptr_type;
+
+		/// @param diagnostics Where the syntax errors go, the parser recovers from them; \c nullptr to fail at the first one
+		explicit ExpressionParser(Cursor& tokens, std::vector<Diagnostic>* diagnostics = nullptr) noexcept
+			: tokens(tokens)
+			, diagnostics(diagnostics)
+		{}
+
+		/// @return The sequence of every token, or \c nullptr when it is empty or ill-formed
+		ptr_type parse()
+		{
+			auto const recorded = diagnostics ? diagnostics->size() : 0u;
+			auto result = sequence(enclosure::text);
+			if (failed) return nullptr;
+			sort_diagnostics(recorded);
+			return result;
+		}
+
+		/// Appends the expressions of the text to @p items, where a text parsed in parts gathers them
+		/// @return false when the text is ill-formed
+		bool parse_items(std::vector<ptr_type>& items)
+		{
+			auto const recorded = diagnostics ? diagnostics->size() : 0u;
+			sequence_items(enclosure::text, items);
+			if (failed) return false;
+			sort_diagnostics(recorded);
+			return true;
+		}
+
+	private:
+		/// Puts the diagnostics from @p recorded on in the order of the text, an unclosed brace is found after what is in it
+		void sort_diagnostics(size_t recorded)
+		{
+			if (diagnostics) std::ranges::stable_sort(diagnostics->begin() + recorded, diagnostics->end(), std::less<>(),
+				[](Diagnostic const& diagnostic) { return diagnostic.at.as_text.data(); });
+		}
+
+		/// What a sequence is in, which tells the closing braces that end it
+		enum class enclosure
+		{
+			text,    ///< the whole text, nothing closes it
+			bracket, ///< a brace other than an indent, closed by the bracket of its kind
+			indent,  ///< closed by a dedent
+		};
+
+		/// Whether the token @p ahead begins an operand: an operator does when it can stand on the left of one
+		bool starts_operand(size_t ahead = 0u) const noexcept
+		{
+			auto const prec = tokens.peek_prec(ahead);
+			if (tokens.peek_id(ahead) == id::none or prec == prec::close) return false;
+			auto const& binding = bind(prec);
+			return not binding.is_operator or binding.is_prefix;
+		}
+
+		/// Whether the next tokens are a dot and an operator taking an operand, \code m.+ a \endcode,
+		/// the expression before the dot qualifying the operator
+		bool at_qualified() const noexcept
+		{
+			if (tokens.peek_id() != id::op_dot) return false;
+			auto const& binding = bind(tokens.peek_prec(1u));
+			return binding.is_operator and binding.level < sequence_level and starts_operand(2u);
+		}
+
+		ptr_type fail()
+		{
+			failed = true;
+			return nullptr;
+		}
+
+		/// Records a syntax error at @p at, unless the parser does not recover
+		/// @return The node of the part of the text with the error
+		ptr_type report(syntax_error error, Token const& at)
+		{
+			if (not diagnostics) return fail();
+			diagnostics->push_back({error, at});
+			return Expression::make<Expression::error>(at);
+		}
+
+		/// Skips to the next line end, dedent or \c ; out of the blocks it skips, where the parse goes on after an error
+		void synchronize()
+		{
+			for (auto depth = 0uz;; tokens.take())
+			{
+				auto const id = tokens.peek_id();
+				if (id == id::none) return;
+				if (id == id::indent) ++depth;
+				else if (id == id::dedent and depth != 0u) --depth;
+				else if (depth == 0u and (id == id::newline or id == id::semicolon or id == id::dedent)) return;
+			}
+		}
+
+		/// The expressions separated by line ends and \c ; up to the closing brace of @p in or the end
+		/// @param closing The bracket that closes a \c enclosure::bracket
+		/// @return \c nullptr when there is none, the only one alone
+		ptr_type sequence(enclosure in, char closing = '\0')
+		{
+			auto expressions = std::vector<ptr_type>();
+			sequence_items(in, expressions, closing);
+			if (failed) return nullptr;
+
+			if (expressions.empty()) return nullptr;
+			if (expressions.size() == 1u) return std::move(expressions.front());
+			return Expression::make<Expression::multiple>(std::move(expressions));
+		}
+
+		/// Appends the expressions of a sequence to @p expressions
+		void sequence_items(enclosure in, std::vector<ptr_type>& expressions, char closing = '\0')
+		{
+			for (;;)
+			{
+				while (bind(tokens.peek_prec()).level == sequence_level) tokens.take();
+				auto const id = tokens.peek_id();
+				if (id == id::none) break;
+				if (tokens.peek_prec() == prec::close)
+				{
+					// a dedent in a bracket leaves the bracket unclosed
+					if (id == id::dedent ? in != enclosure::text : in == enclosure::bracket and bracket_of(tokens.peek_text()) == closing) break;
+
+					auto stray = report(syntax_error::unexpected_close, tokens.take());
+					if (failed) return;
+					expressions.push_back(std::move(stray));
+					// a bracket of another kind is skipped alone, the bracket around goes on to its own close
+					if (in != enclosure::bracket) synchronize();
+					continue;
+				}
+
+				auto expression = this->expression(sequence_level - 1u);
+				if (failed) return;
+				expressions.push_back(std::move(expression));
+			}
+		}
+
+		/// An expression of the operators of up to @p limit level
+		ptr_type expression(uint_fast8_t limit)
+		{
+			auto left = operand();
+			if (failed) return nullptr;
+
+			for (;;)
+			{
+				if (at_qualified())
+				{
+					// a qualified operator; its qualifier is kept when it is left to an outer expression
+					if (bind(tokens.peek_prec(1u)).level > limit) break;
+					tokens.take();
+					auto op = Expression::Operator{std::move(qualifier), tokens.take()};
+					left = infix(std::move(left), std::move(op));
+					if (failed) return nullptr;
+					continue;
+				}
+
+				auto const& binding = bind(tokens.peek_prec());
+				if (binding.is_operator)
+				{
+					if (binding.level > limit) break;
+					left = infix(std::move(left), Expression::Operator{nullptr, tokens.take()});
+					if (failed) return nullptr;
+					continue;
+				}
+
+				if (limit < apply_level or not starts_operand()) break;
+				auto right = tight_operand();
+				if (failed) return nullptr;
+				if (at_qualified()) qualifier = std::move(right);
+				else left = Expression::make<Expression::apply>(std::move(left), std::move(right));
+			}
+			return left;
+		}
+
+		/// An operator taken after its left operand, binary when an operand follows it
+		ptr_type infix(ptr_type left, Expression::Operator op)
+		{
+			if (not starts_operand())
+				return Expression::make<Expression::right>(std::move(left), std::move(op));
+
+			auto const& binding = bind(op.token.prec);
+			auto right = expression(binding.associativity == dir::right ? binding.level : binding.level - 1u);
+			if (failed) return nullptr;
+			return Expression::make<Expression::binary>(std::move(left), std::move(op), std::move(right));
+		}
+
+		/// An operand, with the prefix operators it begins with
+		ptr_type operand()
+		{
+			auto const& binding = bind(tokens.peek_prec());
+			if (not binding.is_operator)
+			{
+				auto chain = tight_operand();
+				if (failed or not at_qualified()) return chain;
+
+				tokens.take();
+				return prefix(Expression::Operator{std::move(chain), tokens.take()});
+			}
+
+			auto op = Expression::Operator{nullptr, tokens.take()};
+			if (not binding.is_prefix or not starts_operand())
+				return Expression::make<Expression::simple>(op.token);
+			return prefix(std::move(op));
+		}
+
+		ptr_type prefix(Expression::Operator op)
+		{
+			auto const& binding = bind(op.token.prec);
+			auto right = expression(binding.associativity == dir::right ? binding.level : binding.level - 1u);
+			if (failed) return nullptr;
+			return Expression::make<Expression::left>(std::move(op), std::move(right));
+		}
+
+		/// A token or a braced sequence, with what applies to it directly after it:
+		/// a member, a call, an adjacent token and a dot
+		ptr_type tight_operand()
+		{
+			auto const token = tokens.take();
+			auto left = bind(token.prec).is_open
+				? braced(Expression::Operator{nullptr, token})
+				: Expression::make<Expression::simple>(token);
+
+			while (not failed)
+			{
+				auto const id = tokens.peek_id();
+				auto const prec = tokens.peek_prec();
+				if (id == id::op_dot)
+				{
+					auto const next = tokens.peek_prec(1u);
+					if (bind(next).is_open)
+					{
+						tokens.take();
+						left = braced(Expression::Operator{std::move(left), tokens.take()});
+					}
+					else if (at_qualified()) break;
+					else if (tokens.peek_id(1u) != id::none and not bind(next).is_operator and next != prec::close)
+					{
+						auto dot = Expression::Operator{nullptr, tokens.take()};
+						auto member = Expression::make<Expression::simple>(tokens.take());
+						left = Expression::make<Expression::binary>(std::move(left), std::move(dot), std::move(member));
+					}
+					else left = Expression::make<Expression::right>(std::move(left), Expression::Operator{nullptr, tokens.take()});
+				}
+				else if (prec == prec::inv_open)
+				{
+					auto open = Expression::Operator{nullptr, tokens.take()};
+					auto mid = sequence(enclosure::bracket, closing_bracket(open.token.as_text));
+					auto close = lexer::none;
+					if (failed) return nullptr;
+					left = take_close(open.token, close)
+						? Expression::make<Expression::right_braced>(std::move(left), std::move(open), std::move(mid), close)
+						: report(syntax_error::unclosed_brace, open.token);
+				}
+				else if (prec == prec::unary)
+					left = Expression::make<Expression::right>(std::move(left), Expression::Operator{nullptr, tokens.take()});
+				else break;
+			}
+			if (failed) return nullptr;
+			return left;
+		}
+
+		/// The sequence after an opening brace and the closing one
+		ptr_type braced(Expression::Operator open)
+		{
+			auto mid = open.token.id == id::indent
+				? sequence(enclosure::indent)
+				: sequence(enclosure::bracket, closing_bracket(open.token.as_text));
+			auto close = lexer::none;
+			if (failed) return nullptr;
+			if (not take_close(open.token, close)) return report(syntax_error::unclosed_brace, open.token);
+			return Expression::make<Expression::braced>(std::move(open), std::move(mid), close);
+		}
+
+		/// Takes the brace closing @p open, after what is in them: a dedent for an indent, the bracket of its kind for a bracket
+		/// @return false when the text or the block around ends first
+		bool take_close(Token const& open, Token& close)
+		{
+			auto const is_indent = open.id == id::indent;
+			if (tokens.peek_prec() != prec::close or is_indent != (tokens.peek_id() == id::dedent)) return false;
+			if (not is_indent and bracket_of(tokens.peek_text()) != closing_bracket(open.as_text)) return false;
+			close = tokens.take();
+			return true;
+		}
+
+		Cursor& tokens;
+		std::vector<Diagnostic>* diagnostics;
+		/// The qualifier of the operator after the next dot, taken by an outer expression
+		ptr_type qualifier;
+		bool failed = false;
+	};
+}
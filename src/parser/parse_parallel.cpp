@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include "../parser.hpp"
+#include "expressions.hpp"
+
+namespace Ru::parse
+{
+	using namespace Ru::lexer;
+	using Ru::ast::Expression;
+
+	namespace
+	{
+		/// Tokens [from, stop) that parse on their own as a run of top-level items
+		struct part
+		{
+			size_t from;
+			size_t stop;
+			/// The items of the part, in their order
+			std::vector<Expression::ptr_type> items = {};
+			std::vector<Diagnostic> diagnostics = {};
+			bool parsed = false;
+		};
+
+		/// Cuts @p tokens after the top-level line ends and \c ; once a part has @p part_size tokens.
+		/// The braces are followed as the parser takes them: a dedent closes the brackets left open in its
+		/// block, and a bracket close out of a bracket of its kind is stray, so the parser is between two items at each cut
+		std::vector<part> split(TokenBuffer const& tokens, size_t part_size)
+		{
+			// the bracket closing each open brace, 0 for an indent
+			auto open = std::vector<char>();
+			auto parts = std::vector<part>();
+			auto from = 0uz;
+
+			auto const ids = tokens.ids();
+			auto const precs = tokens.precs();
+			for (auto i = 0uz; i != tokens.size(); ++i)
+			{
+				auto const binding = bind(precs[i]);
+				if (binding.is_open)
+					open.push_back(ids[i] == id::indent ? '\0' : closing_bracket(tokens[i].as_text));
+				else if (precs[i] == prec::close)
+				{
+					if (ids[i] == id::dedent)
+					{
+						while (not open.empty() and open.back() != '\0') open.pop_back();
+						if (not open.empty()) open.pop_back();
+					}
+					else if (not open.empty() and open.back() != '\0' and open.back() == bracket_of(tokens[i].as_text)) open.pop_back();
+				}
+				else if (open.empty() and binding.level == sequence_level and i + 1u - from >= part_size)
+				{
+					parts.push_back({from, i + 1u});
+					from = i + 1u;
+				}
+			}
+			if (from != tokens.size() or parts.empty()) parts.push_back({from, tokens.size()});
+			return parts;
+		}
+
+		Ru::ast::ExpressionPtr parse_parts(TokenBuffer const& tokens, std::vector<Diagnostic>* diagnostics, size_t part_size)
+		{
+			auto parts = split(tokens, std::max(part_size, 1uz));
+			auto const parse_part = [&tokens, diagnostics](part& each)
+			{
+				auto cursor = BufferCursor(tokens, each.from, each.stop);
+				each.parsed = ExpressionParser(cursor, diagnostics ? &each.diagnostics : nullptr).parse_items(each.items);
+			};
+
+			// A text of one part has nothing to parse in parallel
+			if (parts.size() == 1u)
+			{
+				auto cursor = BufferCursor(tokens);
+				return ExpressionParser(cursor, diagnostics).parse();
+			}
+
+			// A large text has far more parts than threads, so a thread done early takes the next part from the pool's queue.
+			// On a single core the calling thread parses them, with no thread to hand them to
+			auto const threads = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), parts.size());
+			if (threads == 1u) std::ranges::for_each(parts, parse_part);
+			else
+			{
+				auto pool = boost::asio::thread_pool(threads);
+				for (auto& each : parts)
+					boost::asio::post(pool, [&parse_part, &each] { parse_part(each); });
+				pool.join();
+			}
+
+			// The parts are merged in the order of the text, so are their diagnostics;
+			// without recovery the first ill-formed part fails the whole text, as it would fail it alone
+			auto items = std::vector<Expression::ptr_type>();
+			for (auto& each : parts)
+			{
+				if (not each.parsed) return nullptr;
+				if (diagnostics) diagnostics->insert(diagnostics->end(), each.diagnostics.begin(), each.diagnostics.end());
+				std::ranges::move(each.items, std::back_inserter(items));
+			}
+			if (items.empty()) return nullptr;
+			if (items.size() == 1u) return std::move(items.front());
+			return Expression::make<Expression::multiple>(std::move(items));
+		}
+	}
+
+	Ru::ast::ExpressionPtr parse_parallel(TokenBuffer const& tokens, size_t part_size)
+	{
+		return parse_parts(tokens, nullptr, part_size);
+	}
+
+	Ru::ast::ExpressionPtr parse_parallel(TokenBuffer const& tokens, std::vector<Diagnostic>& diagnostics, size_t part_size)
+	{
+		return parse_parts(tokens, &diagnostics, part_size);
+	}
+}
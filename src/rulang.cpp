@@ -3,14 +3,60 @@
 #include <boost/locale.hpp>
 #include <boost/nowide/iostream.hpp>
 #include <direct.h>
+#include <memory_resource>
+#include <span>
+#include <vector>
 #include "rulang.hpp"
+#include "parser.hpp"
+#include "source_manager.hpp"
+#include "lexer/operators.hpp"
+#include "lexer/symbols.hpp"
+#include "lexer/token_buffer.hpp"
 
 using namespace std::string_literals;
 
 void rulang_main(int argc, char *argv[]) try
 {
-	boost::nowide::args _args(argc, argv);
+	// points argv at the arguments converted to UTF-8, for as long as it lives
+	boost::nowide::args const utf8_args(argc, argv);
+	auto const paths = std::span(argv + 1, argv + argc);
 
+	auto sources = Ru::SourceManager();
+	// the names and the literals of every file, freed with the compilation
+	auto interners = Ru::lexer::Interners();
+	// the lexer stages are generators, their frames are reused from file to file
+	auto frames = std::pmr::unsynchronized_pool_resource();
+	auto const pooled = Ru::frame_resource_scope(&frames);
+	for (auto const* path : paths)
+	{
+		auto const file = sources.load(path);
+		auto operators = Ru::lexer::OperatorTable();
+		auto const tokens = Ru::lexer::TokenBuffer(Ru::lexer::lex_batched(sources.text(file), operators, interners));
+
+		auto const error_at = [&](Ru::lexer::Token const& tok) -> auto&
+		{
+			auto const at = sources.lines(file).locate(tok.as_text);
+			auto in_file = Ru::occurance::position_in_file_at();
+			in_file.file_name = sources.path(file).string();
+			in_file.at = &at;
+			return boost::nowide::cerr << "Error " << in_file.to_string() << ": ";
+		};
+
+		for (auto const& tok : tokens)
+		{
+			if (tok.id < Ru::lexer::id::error or tok.id > Ru::lexer::id::error_bad_int) continue;
+
+			if (tok.id == Ru::lexer::id::error_bad_utf8) error_at(tok) << "invalid UTF-8\n";
+			else error_at(tok) << "unexpected " << tok.as_text << '\n';
+		}
+
+		// every syntax error of the file at once; no stage takes the tree yet
+		auto diagnostics = std::vector<Ru::parse::Diagnostic>();
+		Ru::parse::parse(tokens, diagnostics);
+		for (auto const& [error, at] : diagnostics)
+			if (error == Ru::parse::syntax_error::unclosed_brace) error_at(at) << "unclosed " << at.as_text << '\n';
+			else error_at(at) << "unexpected " << at.as_text << '\n';
+	}
 }
 catch (std::exception const& x)
 {
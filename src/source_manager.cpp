@@ -0,0 +1,42 @@
+#include <boost/filesystem/operations.hpp>
+#include "source_manager.hpp"
+
+namespace Ru
+{
+	FileID SourceManager::load(boost::filesystem::path const& path)
+	{
+		auto const canonical = boost::filesystem::weakly_canonical(path);
+		for (auto index = 0uz; index != files.size(); ++index)
+			if (files[index]->path == canonical) return FileID(index);
+
+		auto loaded = std::make_unique<file>();
+		loaded->path = canonical;
+		// A file of no bytes can't be mapped, and has nothing to map
+		if (boost::filesystem::file_size(canonical) != 0u)
+		{
+			loaded->mapping.open(canonical);
+			loaded->text = {loaded->mapping.data(), loaded->mapping.size()};
+		}
+
+		files.push_back(std::move(loaded));
+		return FileID(files.size() - 1u);
+	}
+
+	lexer::LineTable const& SourceManager::lines(FileID id) const
+	{
+		auto const& source = *files[std::to_underlying(id)];
+		std::call_once(source.lines_built, [&] { source.lines.emplace(source.text); });
+		return *source.lines;
+	}
+
+	std::optional<FileID> SourceManager::find(char const* at) const noexcept
+	{
+		for (auto index = 0uz; index != files.size(); ++index)
+		{
+			auto const text = files[index]->text;
+			if (at >= text.data() and at <= text.data() + text.size() and not text.empty())
+				return FileID(index);
+		}
+		return std::nullopt;
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <boost/filesystem/path.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
+#include "lexer/line_table.hpp"
+
+namespace Ru
+{
+	/// @brief A compact handle of a file a SourceManager has loaded
+	enum class FileID : uint32_t {};
+
+	/// The input files of a compilation, mapped read-only into memory.
+	/// The lexer gets the mapped bytes themselves, so the tokens point into the mappings,
+	/// which stay until the manager is destroyed for the diagnostics to quote them
+	class SourceManager
+	{
+	public:
+		SourceManager() = default;
+		SourceManager(SourceManager const&) = delete;
+		void operator=(SourceManager const&) = delete;
+
+		/// Maps a file, a file loaded again keeps its first mapping
+		/// @throw boost::filesystem::filesystem_error or std::ios_base::failure when the file can't be read or mapped
+		FileID load(boost::filesystem::path const& path);
+
+		/// @return The bytes of the file, empty for an empty file
+		std::string_view text(FileID file) const noexcept { return files[std::to_underlying(file)]->text; }
+
+		boost::filesystem::path const& path(FileID file) const noexcept { return files[std::to_underlying(file)]->path; }
+
+		/// @return The line table of the file, built the first time it is needed
+		lexer::LineTable const& lines(FileID file) const;
+
+		/// @return The file a piece of text points into
+		std::optional<FileID> find(char const* at) const noexcept;
+
+		size_t size() const noexcept { return files.size(); }
+
+	private:
+		struct file
+		{
+			boost::filesystem::path path;
+			boost::iostreams::mapped_file_source mapping;
+			std::string_view text;
+			mutable std::once_flag lines_built;
+			mutable std::optional<lexer::LineTable> lines;
+		};
+
+		/// Stable addresses, the line tables are built behind a shared reference
+		std::vector<std::unique_ptr<file>> files;
+	};
+}
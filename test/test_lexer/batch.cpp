@@ -0,0 +1,77 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../../src/lexer.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_batch)
+
+namespace
+{
+	constexpr std::string_view input =
+		"fn main() =>\n"
+		"\treturn a.b.c(1, 2) !in q\n"
+		"x := [1, 2, 3]\n";
+
+	using summary = std::tuple<id, prec, char const*, size_t>;
+
+	std::vector<summary> collect(token_generator tokens)
+	{
+		auto result = std::vector<summary>{};
+		for (auto const& tok : tokens)
+			result.emplace_back(tok.id, tok.prec, tok.as_text.data(), tok.as_text.size());
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(lex_batched_matches_lex)
+{
+	auto const expected = collect(lex(input));
+	for (auto batch_size : {1uz, 3uz, 7uz, default_batch_size})
+	{
+		auto batches = 0uz;
+		auto tokens = std::vector<summary>{};
+		for (auto const& batch : lex_batched(input, batch_size))
+		{
+			BOOST_CHECK(not batch.empty());
+			++batches;
+			for (auto const& tok : batch)
+				tokens.emplace_back(tok.id, tok.prec, tok.as_text.data(), tok.as_text.size());
+		}
+		BOOST_CHECK(tokens == expected);
+		BOOST_CHECK_LE(batches, (expected.size() + batch_size - 1) / batch_size);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(batched_round_trip)
+{
+	auto const expected = collect(lex(input));
+	for (auto batch_size : {1uz, 5uz, default_batch_size})
+	{
+		auto sizes = std::vector<size_t>{};
+		for (auto const& batch : batched(lex(input), batch_size))
+			sizes.push_back(batch.size());
+		BOOST_REQUIRE(not sizes.empty());
+		for (auto i = 0uz; i + 1 < sizes.size(); ++i)
+			BOOST_CHECK_EQUAL(sizes[i], batch_size);
+
+		BOOST_CHECK(collect(unbatched(batched(lex(input), batch_size))) == expected);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(map_batches_stage)
+{
+	auto without_newlines = map_batches(lex_batched(input, 4), [](token_batch batch, std::vector<Token>& out)
+	{
+		for (auto const& tok : batch)
+			if (tok.id != id::newline) out.push_back(tok);
+	});
+
+	auto expected = collect(lex(input));
+	std::erase_if(expected, [](summary const& tok) { return std::get<id>(tok) == id::newline; });
+	BOOST_CHECK(collect(unbatched(std::move(without_newlines))) == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
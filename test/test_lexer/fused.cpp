@@ -0,0 +1,78 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../src/lexer.hpp"
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_fused)
+
+namespace
+{
+	std::vector<Token> collect(token_generator tokens)
+	{
+		auto result = std::vector<Token>{};
+		for (auto const& tok : tokens)
+			result.push_back(tok);
+		return result;
+	}
+
+	/// Checks the fused lexer against the chain of stages, token by token
+	void check_same(std::string_view input)
+	{
+		// the limbs of the big integers live in the interners
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		auto const fused = collect(lex(input, operators, interners));
+		auto const staged = collect(lex_staged(input, interners));
+		BOOST_REQUIRE_EQUAL(fused.size(), staged.size());
+		for (auto i = 0uz; i != fused.size(); ++i)
+		{
+			BOOST_TEST_CONTEXT("input: " << input << ", token " << i)
+			{
+				BOOST_CHECK(fused[i].id == staged[i].id);
+				BOOST_CHECK(fused[i].prec == staged[i].prec);
+				BOOST_CHECK(fused[i].as_text.data() == staged[i].as_text.data());
+				BOOST_CHECK_EQUAL(fused[i].as_text.size(), staged[i].as_text.size());
+				BOOST_CHECK_EQUAL(fused[i].prefix, staged[i].prefix);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(samples)
+{
+	for (std::string_view input : {
+		"",
+		"\n",
+		"fn main() =>\n\treturn a.b.c(1, 2)\n",
+		"x := a !in b and not c\n",
+		"while a <= b\n\ta += .5\n\tb.+c\n",
+		"type T\n\tpub x: int\n\tmut y = x.\n\n",
+		"f(x)[y] ...z\n  g\n    h\n  i\nj\n",
+		"\"abc\" 'c' ## comment\n## line comment\nk\n",
+	})
+		check_same(input);
+}
+
+BOOST_AUTO_TEST_CASE(random_inputs)
+{
+	static constexpr std::string_view pieces[] = {
+		"a", "in", "!", "!in", ".", "..", ".+", "+.", "(", ")", "[", "]",
+		"fn", "=>", ":=", "=", " ", "\n", "\n\t", "\n\t\t", "1", "\"s\"", "x.y", "and", "or",
+	};
+
+	auto rng = std::mt19937(7);
+	for (int round = 0; round != 500; ++round)
+	{
+		auto input = std::string{};
+		for (int i = rng() % 40; i != 0; --i)
+			input += pieces[rng() % std::size(pieces)];
+		check_same(input);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
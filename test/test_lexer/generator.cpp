@@ -0,0 +1,162 @@
+#include <boost/test/unit_test.hpp>
+#include <memory_resource>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+#include "../../src/lexer.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_generator)
+
+namespace
+{
+	/// Counts what goes through it to the global new
+	struct counting_resource : std::pmr::memory_resource
+	{
+		size_t allocated = 0u, deallocated = 0u;
+
+		void* do_allocate(size_t bytes, size_t alignment) override
+		{
+			++allocated;
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void* block, size_t bytes, size_t alignment) override
+		{
+			++deallocated;
+			std::pmr::new_delete_resource()->deallocate(block, bytes, alignment);
+		}
+
+		bool do_is_equal(memory_resource const& other) const noexcept override { return this == &other; }
+	};
+
+	Ru::generator<int const&> count_to(int last)
+	{
+		for (int i = 1; i <= last; ++i)
+			co_yield i;
+	}
+
+	Ru::generator<int const&> fail_after(int last)
+	{
+		for (int i = 1; i <= last; ++i)
+			co_yield i;
+		throw std::runtime_error("failed");
+	}
+
+	/// The numbers from @p first to @p last, one nested generator a number
+	Ru::generator<int const&> nested_range(int first, int last)
+	{
+		if (first > last) co_return;
+		co_yield first;
+		co_yield Ru::elements_of(nested_range(first + 1, last));
+	}
+
+	/// The leaves of a full binary tree of @p depth levels, left to right
+	Ru::generator<int const&> leaves(int depth, int first = 0)
+	{
+		if (depth == 0)
+		{
+			co_yield first;
+			co_return;
+		}
+		co_yield Ru::elements_of(leaves(depth - 1, first));
+		co_yield Ru::elements_of(leaves(depth - 1, first + (1 << (depth - 1))));
+	}
+
+	template <class T>
+	std::vector<int> collect(Ru::generator<T> numbers)
+	{
+		auto result = std::vector<int>();
+		for (auto const& number : numbers)
+			result.push_back(number);
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(frame_resource)
+{
+	auto frames = counting_resource();
+	auto with_frames = std::vector<Token>();
+	{
+		auto const scope = Ru::frame_resource_scope(&frames);
+		for (auto const& tok : lex_staged("fn f(a) =>\n    a + 1\n"))
+			with_frames.push_back(tok);
+	}
+	// lex_raw and every stage
+	BOOST_CHECK_GE(frames.allocated, 10u);
+	BOOST_CHECK_EQUAL(frames.deallocated, frames.allocated);
+
+	// the frames made with no scope go to the global new, and back there when freed in a scope
+	auto tokens = lex_raw("a b");
+	{
+		auto const scope = Ru::frame_resource_scope(&frames);
+		auto const before = frames.allocated;
+		tokens = lex_raw("c d");
+		BOOST_CHECK_EQUAL(frames.allocated, before + 1u);
+	}
+	tokens = lex_raw("e");
+	BOOST_CHECK_EQUAL(frames.deallocated, frames.allocated);
+}
+
+BOOST_AUTO_TEST_CASE(exhaustion)
+{
+	auto numbers = count_to(2);
+	auto it = numbers.begin();
+	BOOST_CHECK_EQUAL(*it, 1);
+	++it;
+	BOOST_CHECK_EQUAL(*it, 2);
+	++it;
+	BOOST_CHECK(not it);
+	BOOST_CHECK_THROW(*it, Ru::returned_generator_error);
+
+	auto failing = fail_after(1);
+	auto failing_it = failing.begin();
+	++failing_it;
+	BOOST_CHECK(not failing_it);
+	BOOST_CHECK_THROW(*failing_it, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(elements_of)
+{
+	auto expected = std::vector<int>(1000);
+	std::iota(expected.begin(), expected.end(), 1);
+	auto const nested = collect(nested_range(1, 1000));
+	BOOST_CHECK_EQUAL_COLLECTIONS(nested.begin(), nested.end(), expected.begin(), expected.end());
+
+	expected.resize(1024);
+	std::iota(expected.begin(), expected.end(), 0);
+	auto const tree = collect(leaves(10));
+	BOOST_CHECK_EQUAL_COLLECTIONS(tree.begin(), tree.end(), expected.begin(), expected.end());
+
+	// any range, and generators that end before they are nested
+	auto const mixed = collect([]() -> Ru::generator<int const&>
+	{
+		auto const numbers = std::vector{1, 2};
+		co_yield Ru::elements_of(numbers);
+		co_yield Ru::elements_of(count_to(0));
+		co_yield Ru::elements_of(count_to(1));
+		co_yield 3;
+	}());
+	BOOST_CHECK((mixed == std::vector{1, 2, 1, 3}));
+
+	// an exception of a nested generator comes out of the one it is nested in
+	auto caught = std::vector<int>();
+	for (auto const& number : []() -> Ru::generator<int const&>
+	{
+		auto failed = false;
+		try
+		{
+			co_yield Ru::elements_of(fail_after(2));
+		}
+		catch (std::runtime_error const&)
+		{
+			failed = true;
+		}
+		if (failed) co_yield -1;
+	}())
+		caught.push_back(number);
+	BOOST_CHECK((caught == std::vector{1, 2, -1}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include "../../src/lexer/keywords.hpp"
+
+using namespace std::string_view_literals;
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_keywords)
+
+static_assert(find_keyword("while") == std::pair{id::kw_while, prec::while_});
+static_assert(find_keyword("_") == std::pair{id::kw__, prec::intern});
+static_assert(not find_keyword("whilst"));
+static_assert(find_keyword_operator(":=") == std::pair{id::op_init, prec::other});
+static_assert(not find_keyword_operator(":=="));
+
+BOOST_AUTO_TEST_CASE(every_keyword)
+{
+	for (auto [text, expected] : {
+		std::pair{"in"sv, id::kw_in}, {"out"sv, id::kw_out}, {"mut"sv, id::kw_mut}, {"const"sv, id::kw_const},
+		{"return"sv, id::kw_return}, {"yield"sv, id::kw_yield}, {"type"sv, id::kw_type}, {"trait"sv, id::kw_trait},
+		{"class"sv, id::kw_class}, {"fn"sv, id::kw_fn}, {"module"sv, id::kw_module}, {"impl"sv, id::kw_impl},
+		{"use"sv, id::kw_use}, {"with"sv, id::kw_with}, {"when"sv, id::kw_when}, {"as"sv, id::kw_as},
+		{"not"sv, id::kw_not}, {"then"sv, id::kw_then}, {"else"sv, id::kw_else}, {"and"sv, id::kw_and},
+		{"or"sv, id::kw_or}, {"for"sv, id::kw_for}, {"while"sv, id::kw_while}, {"_"sv, id::kw__},
+		{"priv"sv, id::kw_priv}, {"pub"sv, id::kw_pub}, {"match"sv, id::kw_match}, {"is"sv, id::kw_is},
+		{"by"sv, id::kw_by}, {"prp"sv, id::kw_prp},
+	})
+	{
+		auto const found = find_keyword(text);
+		BOOST_REQUIRE_MESSAGE(found, text);
+		BOOST_CHECK(found->first == expected);
+	}
+
+	for (auto text : {":="sv, "=>"sv, "!"sv, "..."sv, "="sv, "&"sv, "."sv, "|"sv, ":"sv})
+		BOOST_CHECK_MESSAGE(find_keyword_operator(text), text);
+}
+
+BOOST_AUTO_TEST_CASE(near_misses)
+{
+	for (auto text : {""sv, "i"sv, "inn"sv, "In"sv, "__"sv, "retur"sv, "returns"sv, "fnn"sv, "whi1e"sv, "moduleX"sv})
+		BOOST_CHECK_MESSAGE(not find_keyword(text), text);
+	for (auto text : {""sv, "::"sv, ":=="sv, ".."sv, "=="sv, "=>>"sv, "&&"sv, "||"sv, "!!"sv})
+		BOOST_CHECK_MESSAGE(not find_keyword_operator(text), text);
+}
+
+BOOST_AUTO_TEST_CASE(random_names)
+{
+	static constexpr std::string_view spellings[] = {
+		"in", "out", "mut", "const", "return", "yield", "type", "trait", "class", "fn", "module", "impl", "use", "with",
+		"when", "as", "not", "then", "else", "and", "or", "for", "while", "_", "priv", "pub", "match", "is", "by", "prp",
+	};
+
+	auto rng = std::mt19937(11);
+	for (int round = 0; round != 100000; ++round)
+	{
+		auto text = std::string(1 + rng() % 6, ' ');
+		for (auto& ch : text)
+			ch = "aeinorstu_"[rng() % 10];
+		auto const is_keyword = std::find(std::begin(spellings), std::end(spellings), text) != std::end(spellings);
+		BOOST_CHECK_EQUAL(find_keyword(text).has_value(), is_keyword);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include "../../src/lexer/line_table.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_line_table)
+
+namespace
+{
+	/// Walks the text byte by byte, the way the lexer used to count lines
+	position naive_resolve(std::string_view text, size_t offset)
+	{
+		auto result = position{0, 0};
+		for (auto i = 0uz; i != offset; ++i)
+		{
+			auto const crlf = text[i] == '\r' and i + 1u < text.size() and text[i + 1u] == '\n';
+			if (not crlf and (text[i] == '\r' or text[i] == '\n')) result = {result.line + 1, 0};
+			else if ((text[i] & 0xC0) != 0x80) ++result.column;
+		}
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(resolve)
+{
+	std::string_view const text = "ab\ncd\r\nё = 1\r\rx";
+	auto const table = LineTable(text);
+	BOOST_CHECK_EQUAL(table.line_count(), 5u);
+	BOOST_CHECK_EQUAL(table.line(2), "ё = 1");
+	BOOST_CHECK_EQUAL(table.line(3), "");
+	BOOST_CHECK(table.resolve(0uz) == (position{0, 0}));
+	BOOST_CHECK(table.resolve(text.find('d')) == (position{1, 1}));
+	BOOST_CHECK(table.resolve(text.find('=')) == (position{2, 2}));
+	BOOST_CHECK(table.resolve(text.size()) == (position{4, 1}));
+}
+
+BOOST_AUTO_TEST_CASE(random_texts)
+{
+	static constexpr std::string_view pieces[] = {"a", " ", "\n", "\r", "\r\n", "ё", "語", "\t", "xyz"};
+
+	auto rng = std::mt19937(5);
+	for (int round = 0; round != 200; ++round)
+	{
+		auto text = std::string();
+		for (int i = rng() % 60; i != 0; --i)
+			text += pieces[rng() % std::size(pieces)];
+
+		auto const table = LineTable(text);
+		for (auto offset = 0uz; offset <= text.size(); ++offset)
+			if (offset == text.size() or (text[offset] & 0xC0) != 0x80)
+				BOOST_CHECK_MESSAGE(table.resolve(offset) == naive_resolve(text, offset), text << " at " << offset);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(diagnostics)
+{
+	std::string_view const text = "x := \"\"one\ntwo\"\" + y\n";
+	auto const table = LineTable(text);
+
+	BOOST_CHECK_EQUAL(table.locate(text.substr(5u, 11u)).to_string(), "at 0:5 .. 1:5");
+	BOOST_CHECK_EQUAL(table.locate(text.substr(19u, 1u)).to_string(), "at 1 : 8..9");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,58 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "../../src/lexer/literals.hpp"
+#include "../../src/lexer/operators.hpp"
+
+using namespace Ru::lexer;
+using namespace std::string_view_literals;
+
+BOOST_AUTO_TEST_SUITE(lexer_literals)
+
+namespace
+{
+	std::string decoded(std::string_view body)
+	{
+		auto result = std::string();
+		decode_escapes(body, result);
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(escapes)
+{
+	BOOST_CHECK_EQUAL(decoded("plain"), "plain");
+	BOOST_CHECK_EQUAL(decoded(R"(a\nb\tc\\d\'e\"f)"), "a\nb\tc\\d'e\"f");
+	BOOST_CHECK_EQUAL(decoded(R"(\0)"), "\0"sv);
+	BOOST_CHECK_EQUAL(decoded(R"(\x41\x7e!)"), "A~!");
+	BOOST_CHECK_EQUAL(decoded(R"(\xFF)"), "\xFF");
+	BOOST_CHECK_EQUAL(decoded(R"(\u451\U1F600)"), "ё\U0001F600");
+	BOOST_CHECK_EQUAL(decoded(R"(\x451)"), "ё");
+	BOOST_CHECK_EQUAL(decoded(R"(\uD800\u110000)"), "\xEF\xBF\xBD\xEF\xBF\xBD");
+	BOOST_CHECK_EQUAL(decoded(R"(\u \q\)"), "u q\\");
+}
+
+BOOST_AUTO_TEST_CASE(lexed_literals)
+{
+	auto operators = OperatorTable();
+	auto interners = Interners();
+	auto const& literals = interners.literals;
+	auto tokens = std::vector<Token>();
+	for (auto const& tok : lex(R"(a := "x\ty" + """x	y""" + '\t' + 'q' + "" + '\x41')", operators, interners))
+		if (tok.id == id::string or tok.id == id::character)
+			tokens.push_back(tok);
+
+	BOOST_REQUIRE_EQUAL(tokens.size(), 6u);
+	BOOST_CHECK_EQUAL(literals.spelling(tokens[0].symbol), "x\ty");
+	// equal values are one literal, however they are written
+	BOOST_CHECK(tokens[0].symbol == tokens[1].symbol);
+	BOOST_CHECK_EQUAL(literals.spelling(tokens[2].symbol), "\t");
+	BOOST_CHECK_EQUAL(literals.spelling(tokens[3].symbol), "q");
+	BOOST_CHECK(tokens[4].symbol != Symbol::none);
+	BOOST_CHECK_EQUAL(literals.spelling(tokens[4].symbol), "");
+	BOOST_CHECK_EQUAL(literals.spelling(tokens[5].symbol), "A");
+	// the literals are apart from the names
+	BOOST_CHECK(interners.names.find("x\ty") == Symbol::none);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,110 @@
+#include <boost/test/unit_test.hpp>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "../../src/lexer.hpp"
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+
+using namespace std::string_view_literals;
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_number)
+
+namespace
+{
+	/// The limbs of the big integers live in it, past the lexing
+	auto interners = Interners();
+
+	/// @return The first token of a text, past the newline every text begins with
+	Token first_token(std::string_view input)
+	{
+		auto operators = OperatorTable();
+		auto tokens = lex(input, operators, interners);
+		auto it = tokens.begin();
+		++it;
+		return *it;
+	}
+
+	void check_integer(std::string_view input, std::vector<uint64_t> const& limbs, intptr_t prefix = 0)
+	{
+		BOOST_TEST_CONTEXT(input)
+		{
+			auto const tok = first_token(input);
+			BOOST_REQUIRE(tok.id == id::number);
+			BOOST_CHECK_EQUAL(tok.as_text, input);
+			BOOST_CHECK_EQUAL(tok.prefix, prefix);
+			BOOST_CHECK(tok.number.kind == (limbs.size() == 1u ? Number::kind::integer : Number::kind::big_integer));
+			auto const digits = tok.number.digits();
+			BOOST_CHECK_EQUAL_COLLECTIONS(digits.begin(), digits.end(), limbs.begin(), limbs.end());
+		}
+	}
+
+	void check_floating(std::string_view input, double value, int64_t shift = 0)
+	{
+		BOOST_TEST_CONTEXT(input)
+		{
+			auto const tok = first_token(input);
+			BOOST_REQUIRE(tok.id == id::number);
+			BOOST_CHECK_EQUAL(tok.as_text, input);
+			BOOST_CHECK_EQUAL(tok.shift, shift);
+			BOOST_REQUIRE(tok.number.kind == Number::kind::floating);
+			BOOST_CHECK_EQUAL(tok.number.floating, value);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(integers)
+{
+	check_integer("0", {0u});
+	check_integer("123", {123u});
+	check_integer("1'000'000", {1'000'000u});
+	check_integer("0x1F", {31u}, 2);
+	check_integer("0XfF'fF", {0xFFFFu}, 2);
+	check_integer("0b1010", {10u}, 2);
+	check_integer("18446744073709551615", {std::numeric_limits<uint64_t>::max()});
+	check_integer("18446744073709551616", {0u, 1u});
+	check_integer("0x1'0000'0000'0000'0001", {1u, 1u}, 2);
+	check_integer("340282366920938463463374607431768211456", {0u, 0u, 1u});
+}
+
+BOOST_AUTO_TEST_CASE(floatings)
+{
+	check_floating("1.5", 1.5);
+	check_floating(".5", 0.5);
+	check_floating("0.1", 0.1);
+	check_floating("1e3", 1000.0, 3);
+	check_floating("2'500.0e-3", 2.5, -3);
+	check_floating("1e+2", 100.0, 2);
+	check_floating("0x.8p1", 1.0, 1);
+	check_floating("0x1p-2", 0.25, -2);
+	check_floating("0b1.1p1", 3.0, 1);
+	check_floating("0b.1", 0.5);
+	check_floating("0b1'0000'0001.1", 257.5);
+	check_floating("9007199254740993.0", 9007199254740992.0);
+	check_floating("1e400", std::numeric_limits<double>::infinity(), 400);
+	check_floating("1e-400", 0.0, -400);
+	check_floating("0.000001e310", 1e304, 310);
+}
+
+BOOST_AUTO_TEST_CASE(number_ends)
+{
+	for (auto [input, number] : {
+		std::pair{"1.x"sv, "1"sv},
+		{"1..2"sv, "1"sv},
+		{"0x"sv, "0"sv},
+		{"0xg"sv, "0"sv},
+		{"0b2"sv, "0"sv},
+		{"1e"sv, "1"sv},
+		{"1e+-2"sv, "1"sv},
+		{"1'"sv, "1"sv},
+		{"1''2"sv, "1"sv},
+		{"0x1e3"sv, "0x1e3"sv},
+		{"0x1p"sv, "0x1"sv},
+	})
+		BOOST_CHECK_EQUAL(first_token(input).as_text, number);
+
+	BOOST_CHECK(first_token(".").id != id::number);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/stages.hpp"
+
+using namespace std::string_view_literals;
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_operators)
+
+BOOST_AUTO_TEST_CASE(interning)
+{
+	auto table = OperatorTable();
+	auto const plus = table.intern("+");
+	auto const shift = table.intern("<<=");
+	BOOST_CHECK_NE(plus, 0u);
+	BOOST_CHECK_NE(plus, shift);
+	BOOST_CHECK_EQUAL(table.intern(std::string("+")), plus);
+
+	BOOST_CHECK(table[plus].prec == get_precision("+"));
+	BOOST_CHECK(table[shift].prec == get_precision("<<="));
+	BOOST_CHECK_EQUAL(table[plus].uses, 2u);
+	BOOST_CHECK_EQUAL(table.used().size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(many_spellings)
+{
+	auto table = OperatorTable();
+	auto spellings = std::vector<std::string>{};
+	for (auto const first : "+-*/<>=!~^%")
+		for (auto const second : "+-*/<>=!~^%")
+			spellings.push_back(std::string{first, second, '|'});
+
+	for (int round = 0; round != 2; ++round)
+		for (auto i = 0uz; i != spellings.size(); ++i)
+			BOOST_CHECK_EQUAL(table.intern(spellings[i]), i + 1u);
+
+	for (auto const& entry : table.used())
+	{
+		BOOST_CHECK(entry.prec == get_precision(entry.spelling));
+		BOOST_CHECK_EQUAL(entry.uses, 2u);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(module_report)
+{
+	auto table = OperatorTable();
+	auto interners = Interners();
+	auto text = std::string("x := a + b * c\ny := a + b\nz := a.b\n");
+	for (auto const& tok : lex(text, table, interners))
+	{
+		if (tok.id == id::operator_)
+		{
+			BOOST_REQUIRE_NE(tok.operator_index, 0u);
+			BOOST_CHECK_EQUAL(table[tok.operator_index].spelling, tok.as_text);
+			BOOST_CHECK(tok.prec == get_precision(tok.as_text));
+		}
+	}
+	text.clear();
+
+	auto report = std::vector<std::pair<std::string_view, size_t>>{};
+	for (auto const& entry : table.used())
+		report.emplace_back(entry.spelling, entry.uses);
+
+	auto const expected = std::vector<std::pair<std::string_view, size_t>>{{":=", 3u}, {"+", 2u}, {"*", 1u}, {".", 1u}};
+	BOOST_CHECK(report == expected);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
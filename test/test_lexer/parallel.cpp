@@ -0,0 +1,74 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include <vector>
+#include "../../src/lexer.hpp"
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_parallel)
+
+namespace
+{
+	/// Checks the chunked lexer against the serial one for chunks of every size up to the whole input.
+	/// The chunks intern their names in any order, the lexings share the interners to give them the same symbols
+	void check_same(std::string_view input)
+	{
+		auto interners = Interners();
+		auto serial_operators = OperatorTable();
+		auto serial = std::vector<Token>{};
+		for (auto const& batch : lex_batched(input, serial_operators, interners))
+			serial.insert(serial.end(), batch.begin(), batch.end());
+
+		for (auto chunk_size = 1uz; chunk_size <= input.size() + 1u; ++chunk_size)
+		{
+			auto operators = OperatorTable();
+			auto parallel = std::vector<Token>{};
+			for (auto const& batch : lex_parallel(input, operators, interners, chunk_size, 3u))
+				parallel.insert(parallel.end(), batch.begin(), batch.end());
+
+			BOOST_TEST_CONTEXT("input: " << input << ", chunk size " << chunk_size)
+			{
+				BOOST_REQUIRE_EQUAL(parallel.size(), serial.size());
+				for (auto i = 0uz; i != serial.size(); ++i)
+					BOOST_CHECK_EQUAL(parallel[i], serial[i]);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(samples)
+{
+	for (std::string_view input : {
+		"",
+		"\n\n  \n",
+		"fn main() =>\n\treturn a.b.c(1, 2)\n",
+		"type T\n  pub x: int\n\n  mut y = x.\n\nz\n",
+		"x := \"\"\"\nline\n\nline\n\"\"\" + 1\ny\n",
+		"s := \"unclosed\nmore\nlines\n",
+		"c := '\n' d\r\ne := 1\r\n## comment\r\n\r\nf\r\n",
+		"a !in b\n!\nin\n",
+	})
+		check_same(input);
+}
+
+BOOST_AUTO_TEST_CASE(random_inputs)
+{
+	static constexpr std::string_view pieces[] = {
+		"a", "in", "!", ".", "(", ")", "fn", "=>", "=", " ", "  ", "\n", "\r\n", "\n  ", "\n    ",
+		"1", "\"s\"", "\"", "\"\"\"", "'", "'c'", "## c", "#", "and",
+	};
+
+	auto rng = std::mt19937(12);
+	for (int round = 0; round != 200; ++round)
+	{
+		auto input = std::string{};
+		for (int i = rng() % 30; i != 0; --i)
+			input += pieces[rng() % std::size(pieces)];
+		check_same(input);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/lexer.hpp"
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+#include "../../src/lexer/token_ring.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_pipeline)
+
+BOOST_AUTO_TEST_CASE(ring)
+{
+	// a ring far smaller than what goes through it, so both sides wait for each other
+	auto ring = TokenRing(3u, 4u);
+	constexpr uint16_t block_count = 10'000u;
+
+	auto producer = std::jthread([&]
+	{
+		for (uint16_t i = 0u; i != block_count; ++i)
+		{
+			auto const block = ring.acquire_write();
+			block->resize(block->size() + i % 4u + 1u, Token{.operator_index = i});
+			ring.publish();
+		}
+		ring.close_write();
+	});
+
+	auto read = 0u;
+	while (auto const block = ring.acquire_read())
+	{
+		// a block comes emptied to the producer
+		BOOST_REQUIRE_EQUAL(block->size(), read % 4u + 1u);
+		BOOST_REQUIRE_EQUAL(block->front().operator_index, read);
+		++read;
+		ring.release();
+	}
+	BOOST_CHECK_EQUAL(read, block_count);
+}
+
+BOOST_AUTO_TEST_CASE(closed_by_reader)
+{
+	auto ring = TokenRing(2u, 4u);
+	auto producer = std::jthread([&]
+	{
+		// waits for a free block once the ring is full, until the reader goes
+		while (ring.acquire_write() != nullptr)
+			ring.publish();
+	});
+	BOOST_CHECK(ring.acquire_read() != nullptr);
+	ring.close_read();
+}
+
+BOOST_AUTO_TEST_CASE(lex_pipelined_matches_lex_batched)
+{
+	auto input = std::string();
+	for (int i = 0; i != 500; ++i)
+		input += "fn f" + std::to_string(i) + "(a, b) =>\n    a <+> b.c + \"s\"\n";
+
+	auto interners = Interners();
+	auto serial_operators = OperatorTable();
+	auto serial = std::vector<Token>();
+	for (auto const& batch : lex_batched(input, serial_operators, interners, 16u))
+		serial.insert(serial.end(), batch.begin(), batch.end());
+
+	auto operators = OperatorTable();
+	auto pipelined = std::vector<Token>();
+	for (auto const& batch : lex_pipelined(input, operators, interners, 2u, 16u))
+		pipelined.insert(pipelined.end(), batch.begin(), batch.end());
+
+	BOOST_REQUIRE_EQUAL(pipelined.size(), serial.size());
+	for (auto i = 0uz; i != serial.size(); ++i)
+		BOOST_REQUIRE_EQUAL(pipelined[i], serial[i]);
+
+	// a sequence left early lets its lexing thread go
+	auto more_operators = OperatorTable();
+	auto left = lex_pipelined(input, more_operators, interners, 2u, 16u);
+	BOOST_CHECK(not left.begin()->empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,100 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include "../../src/lexer/relex.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_relex)
+
+namespace
+{
+	/// Checks the tokens kept through the edits against the tokens of the text lexed anew with the same interners
+	void check_same(std::string const& text, TokenBuffer const& tokens, OperatorTable const& operators, Interners& interners)
+	{
+		auto fresh_operators = OperatorTable();
+		auto const fresh = TokenBuffer(lex_batched(text, fresh_operators, interners));
+
+		BOOST_TEST_CONTEXT("text: " << text)
+		{
+			BOOST_REQUIRE_EQUAL(tokens.size(), fresh.size());
+			for (auto i = 0uz; i != fresh.size(); ++i)
+			{
+				auto kept = tokens[i], expected = fresh[i];
+				BOOST_CHECK_EQUAL(operators[kept.operator_index].spelling, fresh_operators[expected.operator_index].spelling);
+				kept.operator_index = expected.operator_index = 0u;
+				BOOST_CHECK_EQUAL(kept, expected);
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(edit_a_line)
+{
+	auto text = std::string();
+	for (int i = 0; i != 100; ++i)
+		text += "fn f(x) =>\n  y := x + 1\n  return \"\"\"a\nb\"\"\"\n\n";
+
+	auto operators = OperatorTable();
+	auto interners = Interners();
+	auto tokens = TokenBuffer(lex_batched(text, operators, interners));
+
+	auto const offset = text.find("x + 1", text.size() / 2u);
+	auto const changed = relex(text, tokens, {.offset = offset, .removed = 1u, .inserted = "value"}, operators, interners);
+	check_same(text, tokens, operators, interners);
+	BOOST_CHECK_LT(changed.removed, 20u);
+	BOOST_CHECK_LT(changed.inserted, 20u);
+
+	// an edit opening a string lexes the rest of the text again
+	relex(text, tokens, {.offset = offset, .removed = 0u, .inserted = "\""}, operators, interners);
+	check_same(text, tokens, operators, interners);
+	relex(text, tokens, {.offset = offset, .removed = 1u, .inserted = ""}, operators, interners);
+	check_same(text, tokens, operators, interners);
+}
+
+BOOST_AUTO_TEST_CASE(edit_after_bad_utf8)
+{
+	// the line ends of the string are in the tokens it is cut into, none is a place to lex again from
+	auto text = std::string("a = \"x\n\xFF\n\" b");
+	auto operators = OperatorTable();
+	auto interners = Interners();
+	auto tokens = TokenBuffer(lex_batched(text, operators, interners));
+
+	relex(text, tokens, {.offset = text.size() - 1u, .removed = 1u, .inserted = "c + d"}, operators, interners);
+	check_same(text, tokens, operators, interners);
+}
+
+BOOST_AUTO_TEST_CASE(random_edits)
+{
+	static constexpr std::string_view pieces[] = {
+		"a", "in", "!", ".", "(", ")", "fn", "=>", ":=", "=", " ", "\n", "\r\n", "\n  ", "\n    ",
+		"1", "0x1F", "\"s\"", "\"", "\"\"\"", "'", "'c'", "## c", "#", "and", "x.y",
+	};
+
+	auto rng = std::mt19937(13);
+	auto const piece = [&] { return pieces[rng() % std::size(pieces)]; };
+
+	for (int round = 0; round != 50; ++round)
+	{
+		auto text = std::string();
+		for (int i = rng() % 60; i != 0; --i)
+			text += piece();
+
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		auto tokens = TokenBuffer(lex_batched(text, operators, interners));
+		for (int edit = 0; edit != 20; ++edit)
+		{
+			auto const offset = rng() % (text.size() + 1u);
+			auto const removed = std::min<size_t>(rng() % 4u, text.size() - offset);
+			auto inserted = std::string();
+			for (int i = rng() % 3; i != 0; --i)
+				inserted += piece();
+
+			relex(text, tokens, {.offset = offset, .removed = removed, .inserted = inserted}, operators, interners);
+			check_same(text, tokens, operators, interners);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,135 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <string>
+#include <string_view>
+#include "../../src/lexer/scan.hpp"
+
+using namespace Ru::lexer;
+using namespace std::string_view_literals;
+
+BOOST_AUTO_TEST_SUITE(lexer_scan)
+
+namespace
+{
+	/// Random text over a small alphabet, so that every kernel meets both its stop and non-stop bytes
+	std::string random_text(std::mt19937& rng, size_t size)
+	{
+		static constexpr char alphabet[] = "aZ09_  \"\"\r\n'.+\x80\xff";
+		auto result = std::string(size, ' ');
+		for (auto& ch : result)
+			ch = alphabet[rng() % (sizeof alphabet - 1)];
+		return result;
+	}
+
+	/// Checks a kernel of every supported set against the scalar one, for every start offset of the text, the end included
+	template <class Kernel>
+	void check_kernel(Kernel scan::kernels::* kernel, auto... args)
+	{
+		auto rng = std::mt19937(42);
+		for (auto size : {0uz, 1uz, 15uz, 16uz, 17uz, 31uz, 32uz, 33uz, 100uz, 1000uz})
+			for (int round = 0; round != 20; ++round)
+			{
+				auto const text = random_text(rng, size);
+				auto const end = text.data() + text.size();
+				for (auto const* kernels : scan::supported())
+					for (auto begin = text.data(); begin <= end; ++begin)
+						BOOST_CHECK_EQUAL(
+							(kernels->*kernel)(begin, end, args...) - text.data(),
+							(scan::scalar().*kernel)(begin, end, args...) - text.data());
+			}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(find_byte)
+{
+	check_kernel(&scan::kernels::find_byte, '"');
+	check_kernel(&scan::kernels::find_byte, '\'');
+}
+
+BOOST_AUTO_TEST_CASE(skip_byte)
+{
+	check_kernel(&scan::kernels::skip_byte, ' ');
+	check_kernel(&scan::kernels::skip_byte, '"');
+}
+
+BOOST_AUTO_TEST_CASE(find_line_end)
+{
+	check_kernel(&scan::kernels::find_line_end);
+}
+
+BOOST_AUTO_TEST_CASE(skip_ascii_word)
+{
+	check_kernel(&scan::kernels::skip_ascii_word);
+}
+
+BOOST_AUTO_TEST_CASE(count_code_points)
+{
+	auto rng = std::mt19937(42);
+	for (auto size : {0uz, 1uz, 15uz, 16uz, 17uz, 31uz, 32uz, 33uz, 100uz, 1000uz})
+		for (int round = 0; round != 20; ++round)
+		{
+			auto const text = random_text(rng, size);
+			auto const end = text.data() + text.size();
+			for (auto const* kernels : scan::supported())
+				for (auto begin = text.data(); begin <= end; ++begin)
+					BOOST_CHECK_EQUAL(kernels->count_code_points(begin, end), scan::scalar().count_code_points(begin, end));
+		}
+}
+
+BOOST_AUTO_TEST_CASE(validate_utf8)
+{
+	for (auto const* kernels : scan::supported())
+		for (auto const [text, invalid] : {
+			std::pair{"plain ascii"sv, 11},
+			{"\xD1\x91 \xE2\x82\xAC \xF0\x9F\x98\x80"sv, 11},
+			{"ab\x80"sv, 2},
+			{"ab\xC0\xAF"sv, 2},          // overlong
+			{"ab\xE0\x9F\xBF"sv, 2},      // overlong
+			{"ab\xED\xA0\x80"sv, 2},      // surrogate
+			{"ab\xF4\x90\x80\x80"sv, 2}, // above U+10FFFF
+			{"ab\xF5\x80\x80\x80"sv, 2},
+			{"ab\xE2\x82"sv, 2},          // truncated
+			{"ab\xE2\x82z"sv, 2},
+			{"ab\xFF"sv, 2},
+		})
+		{
+			// the vectors meet the sequence at every place
+			for (auto pad = 0uz; pad != 40u; ++pad)
+			{
+				auto const padded = std::string(pad, ' ') + std::string(text);
+				BOOST_CHECK_EQUAL(kernels->validate_utf8(padded.data(), padded.data() + padded.size()) - padded.data(), ptrdiff_t(pad) + invalid);
+			}
+		}
+
+	// a sequence across the end of a vector, at every place of it, is well-formed
+	for (auto const character : {"\xD1\x91"sv, "\xE2\x82\xAC"sv, "\xF0\x9F\x98\x80"sv})
+		for (auto pad = 28uz; pad != 32u; ++pad)
+		{
+			// and across the end of the next vector, so the vector loop goes on past the first one
+			auto text = std::string(96u, 'a');
+			text.replace(pad, character.size(), character);
+			text.replace(pad + 32u, character.size(), character);
+			for (auto const* kernels : scan::supported())
+				BOOST_CHECK(kernels->validate_utf8(text.data(), text.data() + text.size()) == text.data() + text.size());
+		}
+
+	// well-formed text, broken here and there
+	static constexpr std::string_view pieces[] = {"a", " ", "\n", "\xD1\x91", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xEF\xBF\xBF"};
+	auto rng = std::mt19937(42);
+	for (auto size : {1uz, 20uz, 40uz, 100uz, 1000uz})
+		for (int round = 0; round != 20; ++round)
+		{
+			auto text = std::string();
+			while (text.size() < size)
+				text += pieces[rng() % std::size(pieces)];
+			if (round % 2 == 1) text[rng() % text.size()] = char(0x80u | rng() % 0x80u);
+			auto const end = text.data() + text.size();
+			for (auto const* kernels : scan::supported())
+				for (auto begin = text.data(); begin <= end; ++begin)
+					BOOST_CHECK_EQUAL(
+						kernels->validate_utf8(begin, end) - text.data(),
+						scan::scalar().validate_utf8(begin, end) - text.data());
+		}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,66 @@
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <fstream>
+#include <string>
+#include "../../src/source_manager.hpp"
+#include "../../src/lexer/token_buffer.hpp"
+
+using namespace Ru;
+
+BOOST_AUTO_TEST_SUITE(source_manager)
+
+namespace
+{
+	/// A file in the temporary directory, removed with the fixture
+	struct temp_file
+	{
+		boost::filesystem::path path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("ru-%%%%-%%%%.ru");
+
+		explicit temp_file(std::string_view content)
+		{
+			std::ofstream(path.string(), std::ios::binary) << content;
+		}
+		~temp_file() { boost::filesystem::remove(path); }
+	};
+}
+
+BOOST_AUTO_TEST_CASE(load)
+{
+	std::string_view const content = "fn main\n\tx = 1\n";
+	auto const source = temp_file(content);
+	auto const empty = temp_file("");
+
+	auto sources = SourceManager();
+	auto const file = sources.load(source.path);
+	BOOST_CHECK_EQUAL(sources.text(file), content);
+	BOOST_CHECK(sources.load(source.path.parent_path() / "." / source.path.filename()) == file);
+
+	auto const none = sources.load(empty.path);
+	BOOST_CHECK(none != file);
+	BOOST_CHECK(sources.text(none).empty());
+	BOOST_CHECK_EQUAL(sources.lines(none).line_count(), 1u);
+	BOOST_CHECK_EQUAL(sources.size(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE(tokens_point_into_mapping)
+{
+	auto const source = temp_file("x = 1\ny = \"text\"\n");
+	auto sources = SourceManager();
+	auto const file = sources.load(source.path);
+	auto const text = sources.text(file);
+
+	for (auto const& tok : lexer::TokenBuffer(lexer::lex_batched(text)))
+	{
+		if (tok.as_text.empty()) continue;
+		BOOST_CHECK(tok.as_text.data() >= text.data() and tok.as_text.data() + tok.as_text.size() <= text.data() + text.size());
+		BOOST_CHECK(sources.find(tok.as_text.data()) == file);
+	}
+
+	BOOST_CHECK(sources.find(text.data() + text.find('y')) == file);
+	auto const elsewhere = std::string("x = 1");
+	BOOST_CHECK(not sources.find(elsewhere.data()));
+	BOOST_CHECK_EQUAL(sources.lines(file).line(1), "y = \"text\"");
+	BOOST_CHECK(sources.lines(file).resolve(text.data() + text.find('"')) == (lexer::position{1, 4}));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,80 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_symbols)
+
+BOOST_AUTO_TEST_CASE(intern)
+{
+	auto interner = Interner();
+	BOOST_CHECK(interner.find("a") == Symbol::none);
+
+	auto const a = interner.intern("a");
+	auto const b = interner.intern(std::string("b"));
+	BOOST_CHECK(a != Symbol::none);
+	BOOST_CHECK(a != b);
+	BOOST_CHECK(interner.intern(std::string("a")) == a);
+	BOOST_CHECK(interner.find("b") == b);
+	BOOST_CHECK_EQUAL(interner.spelling(a), "a");
+	BOOST_CHECK_EQUAL(interner.spelling(Symbol::none), "");
+	BOOST_CHECK_EQUAL(interner.size(), 2u);
+
+	// enough names for the shards to grow their tables a few times
+	auto symbols = std::vector<Symbol>();
+	for (int i = 0; i != 20'000; ++i)
+		symbols.push_back(interner.intern("name" + std::to_string(i)));
+	for (int i = 0; i != 20'000; ++i)
+		BOOST_REQUIRE_EQUAL(interner.spelling(symbols[i]), "name" + std::to_string(i));
+	BOOST_CHECK_EQUAL(interner.size(), 20'002u);
+}
+
+BOOST_AUTO_TEST_CASE(threads)
+{
+	auto interner = Interner();
+	constexpr int thread_count = 4, name_count = 5'000;
+
+	auto found = std::vector<std::vector<Symbol>>(thread_count);
+	{
+		auto workers = std::vector<std::jthread>();
+		for (int t = 0; t != thread_count; ++t)
+			workers.emplace_back([&, t]
+			{
+				// every thread goes through the same names from another place
+				for (int i = 0; i != name_count; ++i)
+					found[t].push_back(interner.intern("n" + std::to_string((i + t * 1'000) % name_count)));
+			});
+	}
+
+	BOOST_CHECK_EQUAL(interner.size(), size_t(name_count));
+	for (int t = 0; t != thread_count; ++t)
+		for (int i = 0; i != name_count; ++i)
+			BOOST_REQUIRE(found[t][i] == interner.find("n" + std::to_string((i + t * 1'000) % name_count)));
+}
+
+BOOST_AUTO_TEST_CASE(lexed_names)
+{
+	auto operators = OperatorTable();
+	auto interners = Interners();
+	auto tokens = std::vector<Token>();
+	for (auto const& tok : lex("abc := fn(abc, ''abc'', x)\n", operators, interners))
+		tokens.push_back(tok);
+
+	auto const abc = interners.names.find("abc");
+	BOOST_CHECK(abc != Symbol::none);
+	BOOST_CHECK(tokens[1].symbol == abc);  // the first token is the newline of the prologue
+	BOOST_CHECK(tokens[3].id == id::kw_fn and tokens[3].symbol == Symbol::none);
+	BOOST_CHECK(tokens[5].symbol == abc);
+	BOOST_CHECK(tokens[7].id == id::identifier and tokens[7].symbol == abc);
+	BOOST_CHECK(tokens[9].symbol == interners.names.find("x"));
+
+	// the names are the compilation's, another one has its own
+	auto other = Interners();
+	BOOST_CHECK(other.names.find("abc") == Symbol::none);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
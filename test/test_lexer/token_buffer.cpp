@@ -0,0 +1,101 @@
+#include <boost/test/unit_test.hpp>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../../src/lexer/operators.hpp"
+#include "../../src/lexer/symbols.hpp"
+#include "../../src/lexer/token_buffer.hpp"
+
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_token_buffer)
+
+namespace
+{
+	/// Checks that the buffer gives back every token of the text as it was
+	void check_round_trip(std::string_view input)
+	{
+		// the limbs of the big integers live in the interners
+		auto operators = OperatorTable();
+		auto interners = Interners();
+		auto expected = std::vector<Token>{};
+		for (auto const& tok : lex(input, operators, interners))
+			expected.push_back(tok);
+
+		auto const buffer = TokenBuffer(lex(input, operators, interners));
+		BOOST_REQUIRE_EQUAL(buffer.size(), expected.size());
+		for (auto i = 0uz; i != expected.size(); ++i)
+		{
+			BOOST_TEST_CONTEXT("input: " << input << ", token " << i)
+			{
+				BOOST_CHECK_EQUAL(buffer[i], expected[i]);
+				BOOST_CHECK(buffer.ids()[i] == expected[i].id);
+				BOOST_CHECK(buffer.precs()[i] == expected[i].prec);
+				BOOST_CHECK_EQUAL(buffer.lengths()[i], expected[i].as_text.size());
+			}
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(samples)
+{
+	for (std::string_view input : {
+		"",
+		"\n\n",
+		"fn main() =>\n\treturn a.b.c(1, 2)\n",
+		"x := 0x1F + 1.5e3 + 18446744073709551616\n",
+		"s := \"\"one\n  two\n three\"\" + ''name''\ny\n",
+		"type T\n\tpub x: int\n\tmut y = x.\n\n",
+		"\r\n\r\na\r\n\tb\r\nc",
+	})
+		check_round_trip(input);
+}
+
+BOOST_AUTO_TEST_CASE(random_inputs)
+{
+	static constexpr std::string_view pieces[] = {
+		"a", "in", "!", ".", "(", ")", "fn", "=>", " ", "\n", "\r\n", "\n\t", "1", "0x2", "1.5",
+		"\"s\"", "\"\"x\ny\"\"", "'c'", "''n''", "## c\n", "+", "=",
+	};
+
+	auto rng = std::mt19937(3);
+	for (int round = 0; round != 300; ++round)
+	{
+		auto input = std::string{};
+		for (int i = rng() % 40; i != 0; --i)
+			input += pieces[rng() % std::size(pieces)];
+		check_round_trip(input);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(compact_form)
+{
+	std::string_view const input = "a := 12 + b\n";
+	auto const buffer = TokenBuffer(lex_batched(input));
+
+	auto it = buffer.begin();
+	++it;
+	BOOST_CHECK(it->id == id::identifier);
+	BOOST_CHECK_EQUAL(it->offset, 0u);
+	BOOST_CHECK_EQUAL(it->length, 1u);
+	BOOST_CHECK_EQUAL(it->extra, 0u);
+
+	++it;
+	++it;
+	BOOST_CHECK(it->id == id::number);
+	BOOST_CHECK_NE(it->extra, 0u);
+	BOOST_CHECK_EQUAL((*it).number.integer, 12u);
+}
+
+BOOST_AUTO_TEST_CASE(too_large)
+{
+	// the text is never read, only its place and size are kept
+	static char const text[] = "a";
+	auto buffer = TokenBuffer();
+	buffer.push_back(Token{.id = id::identifier, .as_text = {text, 1u}});
+	BOOST_CHECK_THROW(buffer.push_back(Token{.id = id::string, .as_text = {text, 1uz << 32u}}), std::length_error);
+	BOOST_CHECK_EQUAL(buffer.size(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
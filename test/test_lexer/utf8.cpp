@@ -0,0 +1,54 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "../../src/lexer.hpp"
+
+using namespace std::string_view_literals;
+using namespace Ru::lexer;
+
+BOOST_AUTO_TEST_SUITE(lexer_utf8)
+
+namespace
+{
+	std::vector<Token> collect(token_generator tokens)
+	{
+		auto result = std::vector<Token>{};
+		for (auto const& tok : tokens)
+			result.push_back(tok);
+		return result;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(bad_utf8)
+{
+	auto const tokens = collect(lex("ёж \xE2\x82 + \x80\x80 \"a\xFF\" ёж\n"sv));
+
+	using enum id;
+	BOOST_REQUIRE_EQUAL(tokens.size(), 9u);
+	BOOST_CHECK(tokens[1].id == identifier and tokens[1].as_text == "ёж");
+	BOOST_CHECK(tokens[2].id == error_bad_utf8 and tokens[2].as_text == "\xE2\x82");
+	BOOST_CHECK(tokens[3].id == operator_);
+	BOOST_CHECK(tokens[4].id == error_bad_utf8 and tokens[4].as_text == "\x80\x80");
+	// the string is cut at the ill-formed sequence, the error takes the rest of it, which is not decoded
+	BOOST_CHECK(tokens[5].id == error_unclosed_string and tokens[5].as_text == "\"a");
+	BOOST_CHECK(tokens[6].id == error_bad_utf8 and tokens[6].as_text == "\xFF\"");
+	BOOST_CHECK(tokens[7].id == identifier and tokens[7].as_text == "ёж");
+}
+
+BOOST_AUTO_TEST_CASE(bad_utf8_in_long_string)
+{
+	// the string runs past the text checked at once, the sequence is found after it
+	auto text = "a = \"" + std::string(64u * 1024u, 'x') + "\n\xC0\x80\n\" b\n";
+	auto const bad = text.find('\xC0');
+	auto const tokens = collect(lex(text));
+
+	BOOST_REQUIRE_GE(tokens.size(), 7u);
+	BOOST_CHECK(tokens[3].id == id::error_unclosed_string);
+	BOOST_CHECK(tokens[3].as_text == std::string_view(text).substr(4u, bad - 4u));
+	BOOST_CHECK(tokens[4].id == id::error_bad_utf8);
+	BOOST_CHECK(tokens[4].as_text.data() == text.data() + bad);
+	BOOST_CHECK(tokens[4].as_text.data() + tokens[4].as_text.size() == text.data() + text.find('"', bad) + 1u);
+	BOOST_CHECK(tokens[5].id == id::identifier and tokens[5].as_text == "b");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,194 @@
+#include <boost/test/unit_test.hpp>
+#include <string>
+#include <vector>
+#include "../../src/lexer.hpp"
+#include "../../src/lexer/token_buffer.hpp"
+#include "../../src/parser.hpp"
+
+using namespace Ru::lexer;
+using Ru::ast::Expression;
+
+BOOST_AUTO_TEST_SUITE(parser_expressions)
+
+namespace
+{
+	std::string text(Token const& tok)
+	{
+		if (tok.id == id::indent) return "{";
+		if (tok.id == id::dedent) return "}";
+		return std::string(tok.as_text);
+	}
+
+	std::string print(Expression const& expr);
+
+	std::string print(Expression::Operator const& op)
+	{
+		return op.left ? print(*op.left) + "." + text(op.token) : text(op.token);
+	}
+
+	std::string print_mid(Expression::mb_ptr const& mid)
+	{
+		return mid ? print(*mid) : "";
+	}
+
+	/// Prints a tree with the binary and unary operators parenthesized, the juxtapositions bracketed
+	std::string print(Expression const& expr)
+	{
+		return expr.visit(Ru::overloads{
+			[](Expression::simple const& e) { return text(e.token); },
+			[](Expression::left const& e) { return "(" + print(e.op) + " " + print(*e.right) + ")"; },
+			[](Expression::right const& e) { return "(" + print(*e.left) + " " + print(e.op) + ")"; },
+			[](Expression::apply const& e) { return "[" + print(*e.left) + " " + print(*e.right) + "]"; },
+			[](Expression::binary const& e) { return "(" + print(*e.left) + " " + print(e.op) + " " + print(*e.right) + ")"; },
+			[](Expression::braced const& e) { return print(e.open) + print_mid(e.mid) + text(e.close); },
+			[](Expression::right_braced const& e) { return print(*e.left) + print(e.open) + print_mid(e.mid) + text(e.close); },
+			[](Expression::multiple const& e)
+			{
+				auto result = std::string();
+				for (auto const& each : e.expressions)
+					result += (result.empty() ? "" : "; ") + print(*each);
+				return result;
+			},
+			[](Expression::error const& e) { return "<error " + text(e.token) + ">"; },
+			[](Expression const&) { return std::string("?"); },
+		});
+	}
+
+	std::string print(Ru::ast::ExpressionPtr const& tree)
+	{
+		return tree ? print(*tree) : "<error>";
+	}
+
+	std::string parse(std::string_view input)
+	{
+		return print(Ru::parse::parse(lex(input)));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(binding)
+{
+	BOOST_CHECK_EQUAL(parse("a + b * c"), "(a + (b * c))");
+	BOOST_CHECK_EQUAL(parse("a - b - c"), "((a - b) - c)");
+	BOOST_CHECK_EQUAL(parse("a ** b ** c"), "(a ** (b ** c))");
+	BOOST_CHECK_EQUAL(parse("a = b = c"), "(a = (b = c))");
+	BOOST_CHECK_EQUAL(parse("f a b + c"), "([[f a] b] + c)");
+	BOOST_CHECK_EQUAL(parse("- a * b + c"), "((- (a * b)) + c)");
+	BOOST_CHECK_EQUAL(parse("not a and b"), "((not a) and b)");
+	BOOST_CHECK_EQUAL(parse("a ,"), "(a ,)");
+}
+
+BOOST_AUTO_TEST_CASE(braces)
+{
+	BOOST_CHECK_EQUAL(parse("f(x, y) + (a)"), "(f((x , y)) + (a))");
+	BOOST_CHECK_EQUAL(parse("f () [a]"), "[[f ()] [a]]");
+	BOOST_CHECK_EQUAL(parse("fn f(a) =>\n    a + 1\n    b\nc"), "(fn (f(a) => {(a + 1); b})); c");
+	// the lexer closes an indent open at the end
+	BOOST_CHECK_EQUAL(parse("fn f =>\n    a\n"), "(fn (f => {a}))");
+	BOOST_CHECK_EQUAL(parse("a\nb; c"), "a; b; c");
+	BOOST_CHECK_EQUAL(parse("(a; b)"), "(a; b)");
+}
+
+BOOST_AUTO_TEST_CASE(qualified)
+{
+	BOOST_CHECK_EQUAL(parse("x m.+ y"), "(x m.+ y)");
+	BOOST_CHECK_EQUAL(parse("m.+ y"), "(m.+ y)");
+	BOOST_CHECK_EQUAL(parse("a.b.c"), "((a . b) . c)");
+	BOOST_CHECK_EQUAL(parse("m.(a)"), "m.(a)");
+}
+
+BOOST_AUTO_TEST_CASE(ill_formed)
+{
+	BOOST_CHECK_EQUAL(parse("(a"), "<error>");
+	BOOST_CHECK_EQUAL(parse("[a)"), "<error>");
+	BOOST_CHECK_EQUAL(parse("a)"), "<error>");
+	BOOST_CHECK_EQUAL(parse(""), "<error>");
+	// a bracket is not closed by the end of the block it is in
+	BOOST_CHECK_EQUAL(parse("fn f =>\n    g(a\nb"), "<error>");
+}
+
+BOOST_AUTO_TEST_CASE(recovery)
+{
+	using Ru::parse::syntax_error;
+	auto diagnostics = std::vector<Ru::parse::Diagnostic>();
+	auto const recovered = [&](std::string_view input)
+	{
+		diagnostics.clear();
+		return print(Ru::parse::parse(lex(input), diagnostics));
+	};
+
+	BOOST_CHECK_EQUAL(recovered("a + b) * c\nd"), "(a + b); <error )>; d");
+	BOOST_REQUIRE_EQUAL(diagnostics.size(), 1u);
+	BOOST_CHECK(diagnostics[0].error == syntax_error::unexpected_close);
+
+	BOOST_CHECK_EQUAL(recovered("fn f =>\n    g(a\n    b\nc"), "(fn (f => {<error (>})); c");
+	BOOST_REQUIRE_EQUAL(diagnostics.size(), 1u);
+	BOOST_CHECK(diagnostics[0].error == syntax_error::unclosed_brace);
+
+	// a bracket is closed by its kind only, one of another kind in it is stray
+	BOOST_CHECK_EQUAL(recovered("(a ] b)"), "(a; <error ]>; b)");
+	BOOST_REQUIRE_EQUAL(diagnostics.size(), 1u);
+	BOOST_CHECK(diagnostics[0].error == syntax_error::unexpected_close);
+
+	BOOST_CHECK_EQUAL(recovered("(a]"), "<error (>");
+	BOOST_REQUIRE_EQUAL(diagnostics.size(), 2u);
+	BOOST_CHECK(diagnostics[0].error == syntax_error::unclosed_brace);
+	BOOST_CHECK(diagnostics[1].error == syntax_error::unexpected_close);
+	BOOST_CHECK_EQUAL(diagnostics[1].at.as_text, "]");
+
+	// every error of a text, in its order
+	auto const input = std::string_view("x)\nfn f =>\n    y] z\n    w\n[v");
+	BOOST_CHECK_EQUAL(recovered(input), "x; <error )>; (fn (f => {y; <error ]>; w})); <error [>");
+	BOOST_REQUIRE_EQUAL(diagnostics.size(), 3u);
+	BOOST_CHECK_EQUAL(diagnostics[0].at.as_text.data() - input.data(), 1);
+	BOOST_CHECK_EQUAL(diagnostics[1].at.as_text, "]");
+	BOOST_CHECK_EQUAL(diagnostics[2].at.as_text, "[");
+	BOOST_CHECK(diagnostics[2].error == syntax_error::unclosed_brace);
+}
+
+BOOST_AUTO_TEST_CASE(streamed)
+{
+	auto const input = std::string_view("fn f(a, b) =>\n    a m.+ b.c\n    (a; b)\nx := [1, 2] f(3)\n");
+	auto const buffered = print(Ru::parse::parse(TokenBuffer(lex_batched(input))));
+	BOOST_CHECK_EQUAL(buffered, "(fn (f((a , b)) => {(a m.+ (b . c)); (a; b)})); (x := [[(1 , 2)] f(3)])");
+	BOOST_CHECK_EQUAL(print(Ru::parse::parse(lex(input))), buffered);
+
+	// the lookahead runs across the batches
+	for (auto const batch_size : {1uz, 2uz, 3uz, 5uz})
+		BOOST_CHECK_EQUAL(print(Ru::parse::parse(lex_batched(input, batch_size))), buffered);
+}
+
+BOOST_AUTO_TEST_CASE(parallel)
+{
+	auto input = std::string();
+	for (int i = 0; i != 200; ++i)
+		input += "fn f" + std::to_string(i) + "(a, b) =>\n    g(a,\n      b); c\n    [a]\nx := f" + std::to_string(i) + " 1; y\n";
+	auto const tokens = TokenBuffer(lex_batched(input));
+	auto const serial = print(Ru::parse::parse(tokens));
+	for (auto const part_size : {1uz, 7uz, 64uz, Ru::parse::default_part_size})
+		BOOST_CHECK_EQUAL(print(Ru::parse::parse_parallel(tokens, part_size)), serial);
+
+	// the parts are cut where the serial parse is between two items, whatever the braces around
+	constexpr std::string_view pieces[] = {"a", " b", "(", ")", "[", "]", "\n", "\n    ", ";", " + ", "fn f =>\n    "};
+	auto seed = 1u;
+	for (int i = 0; i != 200; ++i)
+	{
+		auto soup = std::string();
+		for (int j = 0; j != 40; ++j)
+		{
+			seed = seed * 1664525u + 1013904223u;
+			soup += pieces[(seed >> 16u) % std::size(pieces)];
+		}
+		auto const soup_tokens = TokenBuffer(lex_batched(soup));
+		auto serial_diagnostics = std::vector<Ru::parse::Diagnostic>();
+		auto parallel_diagnostics = std::vector<Ru::parse::Diagnostic>();
+		BOOST_CHECK_EQUAL(print(Ru::parse::parse_parallel(soup_tokens, 1u)), print(Ru::parse::parse(soup_tokens)));
+		BOOST_CHECK_EQUAL(
+			print(Ru::parse::parse_parallel(soup_tokens, parallel_diagnostics, 1u)),
+			print(Ru::parse::parse(soup_tokens, serial_diagnostics)));
+		BOOST_REQUIRE_EQUAL(parallel_diagnostics.size(), serial_diagnostics.size());
+		for (auto k = 0uz; k != serial_diagnostics.size(); ++k)
+			BOOST_CHECK(parallel_diagnostics[k].at.as_text.data() == serial_diagnostics[k].at.as_text.data());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Generates src/lexer/char_class_tables.hpp, the lexer's Unicode character classes.
+
+XID_Start/XID_Continue are derived as UAX #31 defines them: from the general
+categories, Other_ID_Start/Other_ID_Continue, minus Pattern_Syntax and
+Pattern_White_Space, then closed under NFKC. Punctuation is every P* and S*
+code point that can't continue a name, graph is every L, M, N, P and S one.
+
+Usage: tools/gen_char_classes.py > src/lexer/char_class_tables.hpp
+"""
+import sys
+import unicodedata
+
+START, CONT, PUNCT, GRAPH = 1 << 0, 1 << 1, 1 << 2, 1 << 3
+BLOCK = 128
+FIRST = 0x80
+LAST = 0x10FFFF
+
+OTHER_ID_START = {0x1885, 0x1886, 0x2118, 0x212E, 0x309B, 0x309C}
+OTHER_ID_CONTINUE = {0x00B7, 0x0387, *range(0x1369, 0x1372), 0x19DA}
+PATTERN_WHITE_SPACE = {*range(0x09, 0x0E), 0x20, 0x85, 0x200E, 0x200F, 0x2028, 0x2029}
+PATTERN_SYNTAX = {
+    *range(0x21, 0x30), *range(0x3A, 0x41), *range(0x5B, 0x5F), 0x60, *range(0x7B, 0x7F),
+    *range(0xA1, 0xA8), 0xA9, 0xAB, 0xAC, 0xAE, 0xB0, 0xB1, 0xB6, 0xBB, 0xBF, 0xD7, 0xF7,
+    *range(0x2010, 0x2028), *range(0x2030, 0x203F), *range(0x2041, 0x2054), *range(0x2055, 0x205F),
+    *range(0x2190, 0x2460), *range(0x2500, 0x2776), *range(0x2794, 0x2C00), *range(0x2E00, 0x2E80),
+    *range(0x3001, 0x3004), *range(0x3008, 0x3021), 0x3030, 0xFD3E, 0xFD3F, 0xFE45, 0xFE46,
+}
+
+
+def category(cp):
+    return unicodedata.category(chr(cp))
+
+
+def is_id_start(cp):
+    if cp in PATTERN_SYNTAX or cp in PATTERN_WHITE_SPACE:
+        return False
+    return category(cp) in ('Lu', 'Ll', 'Lt', 'Lm', 'Lo', 'Nl') or cp in OTHER_ID_START
+
+
+def is_id_continue(cp):
+    if cp in PATTERN_SYNTAX or cp in PATTERN_WHITE_SPACE:
+        return False
+    return is_id_start(cp) or category(cp) in ('Mn', 'Mc', 'Nd', 'Pc') or cp in OTHER_ID_CONTINUE
+
+
+def is_xid_start(cp):
+    if not is_id_start(cp):
+        return False
+    normal = [ord(ch) for ch in unicodedata.normalize('NFKC', chr(cp))]
+    return is_id_start(normal[0]) and all(is_id_continue(ch) for ch in normal[1:])
+
+
+def is_xid_continue(cp):
+    if not is_id_continue(cp):
+        return False
+    return all(is_id_continue(ord(ch)) for ch in unicodedata.normalize('NFKC', chr(cp)))
+
+
+def classes(cp):
+    if 0xD800 <= cp <= 0xDFFF:
+        return 0
+    result = 0
+    if is_xid_start(cp):
+        result |= START
+    if is_xid_continue(cp):
+        result |= CONT
+    major = category(cp)[0]
+    if major in 'PS' and not result & CONT:
+        result |= PUNCT
+    if major in 'LMNPS':
+        result |= GRAPH
+    return result
+
+
+def main():
+    blocks = []
+    block_ids = {}
+    index = []
+    for first in range(0, LAST + 1, BLOCK):
+        block = tuple(classes(cp) if cp >= FIRST else 0 for cp in range(first, first + BLOCK))
+        if block not in block_ids:
+            block_ids[block] = len(blocks)
+            blocks.append(block)
+        index.append(block_ids[block])
+
+    index_type = 'uint8_t' if len(blocks) <= 0x100 else 'uint16_t'
+    out = sys.stdout
+    out.write('// Generated by tools/gen_char_classes.py from Unicode %s, do not edit\n' % unicodedata.unidata_version)
+    out.write('#pragma once\n#include <cstdint>\n\n')
+    out.write('namespace Ru::lexer::chars::tables\n{\n')
+    out.write('\tconstexpr inline unsigned block_bits = %d;\n\n' % (BLOCK.bit_length() - 1))
+    out.write('\t/// The block of each %d code points, up to U+10FFFF\n' % BLOCK)
+    out.write('\tconstexpr inline %s index[%d]\n\t{\n' % (index_type, len(index)))
+    for row in range(0, len(index), 32):
+        out.write('\t\t' + ' '.join('%d,' % i for i in index[row:row + 32]) + '\n')
+    out.write('\t};\n\n')
+    out.write('\t/// The class flags of each code point of a block\n')
+    out.write('\tconstexpr inline uint8_t blocks[%d][%d]\n\t{\n' % (len(blocks), BLOCK))
+    for block in blocks:
+        out.write('\t\t{' + ','.join(str(c) for c in block) + '},\n')
+    out.write('\t};\n}\n')
+
+
+if __name__ == '__main__':
+    main()